@@ -21,6 +21,7 @@ protected:
     shared_ptr<CuckooHashTable> clientHashTable;
     shared_ptr<DlogEllipticCurve> dlog;
     AddHomElGamalEnc encryptor;
+    AddHomElGamalEnc resultDecryptor; // Same keys as encryptor, own native group for the thread that receives the results
     TabulationHashing hashfunction;
 
     // vector to store the encrypted elements during the offline phase
@@ -36,22 +37,22 @@ protected:
 
     void setUpElGamalPSI()
     {
+        // ristretto255 has no libscapi group, it always uses the native backend and native keys
+        bool ristretto = clientParams.curveName == RISTRETTO255_CURVE_NAME;
 
-        // Choose right NIST curve from OpenSSL
-        if (clientParams.curveName[0] == 'P')
-        {
-            dlog = make_shared<OpenSSLDlogECFp>(OpenSSLCurveDir, clientParams.curveName);
-        }
-        else if (clientParams.curveName[0] == 'B' or clientParams.curveName[0] == 'K')
+        if (ristretto)
         {
-            dlog = make_shared<OpenSSLDlogECF2m>(OpenSSLCurveDir, clientParams.curveName);
+            encryptor.enableNativeBackend(clientParams.curveName);
         }
         else
         {
-            throw invalid_argument("Cannot find curveName");
+            dlog = createDlogGroup();
+            encryptor = AddHomElGamalEnc(dlog);
+            if (clientParams.nativeEC)
+            {
+                encryptor.enableNativeBackend(clientParams.curveName);
+            }
         }
-
-        encryptor = AddHomElGamalEnc(dlog);
         resultSize = htParams.maxItemsPerPosition * htParams.numberOfCuckooHashFunctions + htParams.serverStashSize;
 
         // number of needed hashfunctions
@@ -68,12 +69,47 @@ protected:
                                                        htParams.eachSimpleTableSize, htParams.numberOfSimpleHashFunctions, startingHashId, maxStashSize,
                                                        htParams.simpleMultiTable);
 
-        pair<shared_ptr<PublicKey>, shared_ptr<PrivateKey>> pair = encryptor.generateKey();
-        encryptor.setKey(pair.first, pair.second);
 #ifdef VERBOSE
         cout << "Send public key to server" << endl;
 #endif
+        if (ristretto)
+        {
+            encryptor.generateNativeKey();
+            channel->writeWithSize(encryptor.getEncodedNativePublicKey());
+            resultDecryptor = encryptor.forkNative();
+            return;
+        }
+        pair<shared_ptr<PublicKey>, shared_ptr<PrivateKey>> pair = encryptor.generateKey();
+        encryptor.setKey(pair.first, pair.second);
         sendPublicKey(pair.first);
+
+        if (encryptor.usesNativeBackend())
+        {
+            resultDecryptor = encryptor.forkNative();
+        }
+        else
+        {
+            // Same keys and libscapi group as encryptor, without loading the curve again: the results are only decoded and
+            // checked for zero, which the native backend does without the (not thread-safe) libscapi group
+            resultDecryptor = encryptor;
+            resultDecryptor.enableNativeBackend(clientParams.curveName);
+        }
+    }
+
+    /**
+     * @brief Chooses the right NIST curve from OpenSSL.
+     */
+    shared_ptr<DlogEllipticCurve> createDlogGroup()
+    {
+        if (clientParams.curveName[0] == 'P')
+        {
+            return make_shared<OpenSSLDlogECFp>(OpenSSLCurveDir, clientParams.curveName);
+        }
+        else if (clientParams.curveName[0] == 'B' or clientParams.curveName[0] == 'K')
+        {
+            return make_shared<OpenSSLDlogECF2m>(OpenSSLCurveDir, clientParams.curveName);
+        }
+        throw invalid_argument("Cannot find curveName");
     }
 
     void sendPublicKey(shared_ptr<PublicKey> &publicKey)
@@ -90,7 +126,7 @@ protected:
 
     /**
      * @brief Method that receives the server result for one cuckoo table position.
-     *        Avoids decryption if element has already been found.
+     *        Avoids decryption if element has already been found. Uses resultDecryptor, i.e., may run while encryptor sends.
      *
      * @return true if element is in the client set
      * @return false otherwise
@@ -98,15 +134,15 @@ protected:
     bool receiveResult()
     {
         bool found = false;
-
+        // One buffer for all results, the channel reuses the previous one for a later message
+        vector<unsigned char> cipherVector;
         for (int i = 0; i < resultSize; i++)
         {
-            vector<unsigned char> cipherVector;
             channel->readWithSizeIntoVector(cipherVector);
             if (!found)
             {
-                auto cipherText = encryptor.reconstructCiphertext(cipherVector, false);
-                if (encryptor.decryptsToZero(cipherText.get()))
+                auto cipherText = resultDecryptor.reconstructCiphertext(cipherVector, false);
+                if (resultDecryptor.decryptsToZero(cipherText.get()))
                 {
                     found = true;
                 }
@@ -59,9 +59,19 @@ void PrecompElGamalPSIClient::runOfflinePhase()
             }
             encryptedCuckooTable[i][j] = encryptor.encrypt(elemPlain);
         }
+        encryptor.normalizeBatch(encryptedCuckooTable[i]);
     }
 }
 void PrecompElGamalPSIClient::runOnlinePhase()
+{
+    // The server streams the results as its PIEs complete, they are decrypted while the remaining requests are sent
+    sendWhileReceiving([this]
+                       { sendRequests(); },
+                       [this]
+                       { receiveResults(); });
+}
+
+void PrecompElGamalPSIClient::sendRequests()
 {
     prg.setKey(prgSecretKey); // Reset PRG
 
@@ -76,7 +86,10 @@ void PrecompElGamalPSIClient::runOnlinePhase()
             sendMinusCompareElement(encryptedCuckooTable[i][j]);
         }
     }
+}
 
+void PrecompElGamalPSIClient::receiveResults()
+{
     // Iterate over all cuckoo table entries, assumes bin size is 1 (second cuckoo table axis), receive PIE result
     for (uint i = 0; i < clientHashTable->getNumberOfTables(); i++)
     {
@@ -106,6 +119,8 @@ void PrecompElGamalPSIClient::createAndSendRandomIndexMatrix()
     vector<byte> randomBits(randomVectorSize);
     prg.getPRGBytes(randomBits, 0, randomVectorSize);
     boost::dynamic_bitset<byte> mbitset(randomBits.begin(), randomBits.end());
+    vector<shared_ptr<AsymmetricCiphertext>> encryptedIndexMatrix;
+    encryptedIndexMatrix.reserve(htParams.numberOfCuckooHashFunctions * htParams.eachCuckooTableSize);
     for (uint hfInd = 0; hfInd < htParams.numberOfCuckooHashFunctions; hfInd++)
     {
         for (uint64_t vectorIndex = 0; vectorIndex < htParams.eachCuckooTableSize; vectorIndex++)
@@ -119,10 +134,19 @@ void PrecompElGamalPSIClient::createAndSendRandomIndexMatrix()
             {
                 plain = plainZero;
             }
-            shared_ptr<AsymmetricCiphertext> encryptedIndex = encryptor.encrypt(plain);
-            channel->writeWithSize(encryptedIndex->generateSendableData()->toString());
+            encryptedIndexMatrix.push_back(encryptor.encrypt(plain));
         }
     }
+
+    // Normalize the whole matrix at once before encoding
+    encryptor.normalizeBatch(encryptedIndexMatrix);
+    vector<string> batch;
+    batch.reserve(encryptedIndexMatrix.size());
+    for (auto &encryptedIndex : encryptedIndexMatrix)
+    {
+        batch.push_back(encryptedIndex->generateSendableData()->toString());
+    }
+    channel->writeBatch(std::move(batch));
 }
 
 /**
@@ -20,6 +20,9 @@ private:
     void createAndSendPlainBitvector(biginteger &element);
     void createAndSendRandomIndexMatrix();
 
+    void sendRequests();
+    void receiveResults();
+
     inline std::string protocolName()
     {
         return "PrecompElGamal";
@@ -47,9 +47,19 @@ void SimpleElGamalPSIClient::runOfflinePhase()
             // Create Index Vector
             encryptedCuckooIndexMatrices[i][j] = generateIndexMatrix(currentElem);
         }
+        encryptor.normalizeBatch(encryptedCuckooTable[i]);
     }
 }
 void SimpleElGamalPSIClient::runOnlinePhase()
+{
+    // The server streams the results as its PIEs complete, they are decrypted while the remaining requests are sent
+    sendWhileReceiving([this]
+                       { sendRequests(); },
+                       [this]
+                       { receiveResults(); });
+}
+
+void SimpleElGamalPSIClient::sendRequests()
 {
     // Iterate over all cuckoo table entries, assumes bin size is 1 (second cuckoo table axis)
     for (uint i = 0; i < clientHashTable->getNumberOfTables(); i++)
@@ -62,6 +72,10 @@ void SimpleElGamalPSIClient::runOnlinePhase()
             sendMinusCompareElement(encryptedCuckooTable[i][j]);
         }
     }
+}
+
+void SimpleElGamalPSIClient::receiveResults()
+{
     // Iterate over all cuckoo table entries, assumes bin size is 1 (second cuckoo table axis)
     for (uint i = 0; i < clientHashTable->getNumberOfTables(); i++)
     {
@@ -109,6 +123,7 @@ indexVectorType *SimpleElGamalPSIClient::generateIndexMatrix(biginteger &element
             shared_ptr<AsymmetricCiphertext> encryptedIndex = encryptor.encrypt(plain);
             (*indexMatrix)[hfInd][vectorIndex] = encryptedIndex;
         }
+        encryptor.normalizeBatch((*indexMatrix)[hfInd]);
     }
     return indexMatrix;
 }
@@ -121,14 +136,13 @@ indexVectorType *SimpleElGamalPSIClient::generateIndexMatrix(biginteger &element
  */
 void SimpleElGamalPSIClient::sendIndexMatrix(indexVectorType *indexMatrix)
 {
-
+    vector<string> batch;
     for (size_t i = 0; i < indexMatrix->size(); i++)
     {
         for (size_t j = 0; j < (*indexMatrix)[i].size(); j++)
         {
-
-            string cipherTextString = (*indexMatrix)[i][j]->generateSendableData()->toString();
-            channel->writeWithSize(cipherTextString);
+            batch.push_back((*indexMatrix)[i][j]->generateSendableData()->toString());
         }
     }
+    channel->writeBatch(std::move(batch));
 }
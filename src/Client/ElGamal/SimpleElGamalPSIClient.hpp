@@ -16,6 +16,9 @@ private:
     indexVectorType *generateIndexMatrix(biginteger &element);
     void sendIndexMatrix(indexVectorType *indexMatrix);
 
+    void sendRequests();
+    void receiveResults();
+
     inline std::string protocolName()
     {
         return "SimpleElGamal";
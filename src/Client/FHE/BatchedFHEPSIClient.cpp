@@ -1,5 +1,6 @@
 #include "BatchedFHEPSIClient.hpp"
 #include "src/Common/DataInput/RandomDataInput.hpp"
+#include "src/Common/WireStreams.hpp"
 #include "ciphertext-ser.h"
 #include "cryptocontext-ser.h"
 #include "key/key-ser.h"
@@ -195,67 +196,70 @@ void BatchedFHEPSIClient::runOnlinePhase()
 void BatchedFHEPSIClient::sendEncryptedMinusElements()
 {
 
-    auto cryptoSerStream = std::ostringstream();
+    StringOutStream cryptoSerStream;
     lbcrypto::Serial::Serialize(encryptedMinusElements, cryptoSerStream, defaultSerType);
-    channel->writeWithSize(cryptoSerStream.str());
+    channel->writeWithSize(cryptoSerStream.take());
 }
 
 void BatchedFHEPSIClient::sendIndexMatrix()
 {
 
+    vector<string> batch;
+    size_t serializedSize = 4096; // all ciphertexts have about the same size, start each with the size of the previous one
     for (uint i = 0; i < htParams.numberOfCuckooHashFunctions; i++)
     {
         for (size_t j = 0; j < htParams.eachCuckooTableSize; j++)
         {
-            auto cryptoSerStream = std::ostringstream();
+            StringOutStream cryptoSerStream(serializedSize);
             lbcrypto::Serial::Serialize(batchedEncryptedIndexMatrix[i][j], cryptoSerStream, defaultSerType);
-            channel->writeWithSize(cryptoSerStream.str());
+            serializedSize = cryptoSerStream.size();
+            batch.push_back(cryptoSerStream.take());
         }
     }
+    channel->writeBatch(std::move(batch));
 }
 
 void BatchedFHEPSIClient::sendContextAndKeys()
 {
 
     // Serialize cryptocontext
-    auto cryptoSerStream = std::ostringstream();
+    StringOutStream cryptoSerStream;
     lbcrypto::Serial::Serialize(cryptoContext, cryptoSerStream, defaultSerType);
-    channel->writeWithSize(cryptoSerStream.str());
 #ifdef VERBOSE
-    std::cout << "The cryptocontext has been sent:" << cryptoSerStream.str().size() << std::endl;
+    std::cout << "The cryptocontext has been sent:" << cryptoSerStream.size() << std::endl;
 #endif
+    channel->writeWithSize(cryptoSerStream.take());
 
     // Sample Program: Step 3 - Encryption
 
     // Serialize public key
-    auto pKSerStream = std::ostringstream();
+    StringOutStream pKSerStream;
     lbcrypto::Serial::Serialize(keyPair.publicKey, pKSerStream, defaultSerType);
-    channel->writeWithSize(pKSerStream.str());
 #ifdef VERBOSE
-    std::cout << "The public key has been sent:" << pKSerStream.str().size() << std::endl;
+    std::cout << "The public key has been sent:" << pKSerStream.size() << std::endl;
 #endif
+    channel->writeWithSize(pKSerStream.take());
 
     // Serialize Mult Keys
 
-    auto mKSerStream = std::ostringstream();
+    StringOutStream mKSerStream;
     cryptoContext->SerializeEvalMultKey(mKSerStream, defaultSerType);
-    channel->writeWithSize(mKSerStream.str());
-
 #ifdef VERBOSE
-    std::cout << "The mult keys have been sent:" << mKSerStream.str().size() << std::endl;
+    std::cout << "The mult keys have been sent:" << mKSerStream.size() << std::endl;
 #endif
+    channel->writeWithSize(mKSerStream.take());
 }
 
 void BatchedFHEPSIClient::receiveAndStoreResult()
 {
 
     batchedDecryptedResult = vector<vector<int64_t>>(htParams.maxItemsPerPosition, vector<int64_t>());
+    vector<unsigned char> cipherVector;
     for (size_t binIndex = 0; binIndex < htParams.maxItemsPerPosition; binIndex++)
     {
         lbcrypto::Ciphertext<FHEEncType> ciphertext;
-        vector<unsigned char> cipherVector;
         channel->readWithSizeIntoVector(cipherVector);
-        auto ctSS = std::istringstream(std::string(cipherVector.begin(), cipherVector.end()));
+        FrameInStream ctSS(cipherVector);
         lbcrypto::Serial::Deserialize(ciphertext, ctSS, defaultSerType);
         lbcrypto::Plaintext plaintext;
         cryptoContext->Decrypt(keyPair.secretKey, ciphertext, &plaintext);
@@ -6,6 +6,7 @@
  */
 #include "SimpleFHEPSIClient.hpp"
 #include "src/Common/DataInput/RandomDataInput.hpp"
+#include "src/Common/WireStreams.hpp"
 #include "ciphertext-ser.h"
 #include "cryptocontext-ser.h"
 #include "key/key-ser.h"
@@ -159,6 +160,15 @@ void SimpleFHEPSIClient::runOfflinePhase()
     }
 }
 void SimpleFHEPSIClient::runOnlinePhase()
+{
+    // The server streams the results as its PIEs complete, they are decrypted while the remaining requests are sent
+    sendWhileReceiving([this]
+                       { sendRequests(); },
+                       [this]
+                       { receiveResults(); });
+}
+
+void SimpleFHEPSIClient::sendRequests()
 {
 
     for (uint i = 0; i < clientHashTable->getNumberOfTables(); i++)
@@ -169,7 +179,10 @@ void SimpleFHEPSIClient::runOnlinePhase()
             sendIndexMatrix(encryptedCuckooIndexMatrices[i][j]);
         }
     }
+}
 
+void SimpleFHEPSIClient::receiveResults()
+{
     for (uint i = 0; i < clientHashTable->getNumberOfTables(); i++)
     {
         for (size_t j = 0; j < clientHashTable->cuckooTable[i][0].size(); j++)
@@ -187,67 +200,67 @@ void SimpleFHEPSIClient::runOnlinePhase()
 
 void SimpleFHEPSIClient::sendIndexMatrix(indexFHEVectorType *indexMatrix)
 {
-
+    vector<string> batch;
+    size_t serializedSize = 4096; // all ciphertexts have about the same size, start each with the size of the previous one
     for (size_t i = 0; i < indexMatrix->size(); i++)
     {
-
-        auto cryptoSerStream = std::ostringstream();
+        StringOutStream cryptoSerStream(serializedSize);
         lbcrypto::Serial::Serialize((*indexMatrix)[i], cryptoSerStream, defaultSerType);
-        channel->writeWithSize(cryptoSerStream.str());
+        serializedSize = cryptoSerStream.size();
+        batch.push_back(cryptoSerStream.take());
     }
+    channel->writeBatch(std::move(batch));
 }
 
 void SimpleFHEPSIClient::sendContextAndKeys()
 {
 
     // Serialize cryptocontext
-    auto cryptoSerStream = std::ostringstream();
+    StringOutStream cryptoSerStream;
     lbcrypto::Serial::Serialize(cryptoContext, cryptoSerStream, defaultSerType);
-    channel->writeWithSize(cryptoSerStream.str());
 #ifdef VERBOSE
-    std::cout << "The cryptocontext has been sent:" << cryptoSerStream.str().size() << std::endl;
+    std::cout << "The cryptocontext has been sent:" << cryptoSerStream.size() << std::endl;
 #endif
+    channel->writeWithSize(cryptoSerStream.take());
 
     // Sample Program: Step 3 - Encryption
 
     // Serialize public key
-    auto pKSerStream = std::ostringstream();
+    StringOutStream pKSerStream;
     lbcrypto::Serial::Serialize(keyPair.publicKey, pKSerStream, defaultSerType);
-    channel->writeWithSize(pKSerStream.str());
 #ifdef VERBOSE
-    std::cout << "The public key has been sent:" << pKSerStream.str().size() << std::endl;
+    std::cout << "The public key has been sent:" << pKSerStream.size() << std::endl;
 #endif
+    channel->writeWithSize(pKSerStream.take());
 
     // Serialize Sum Keys
 
-    auto sKSerStream = std::ostringstream();
+    StringOutStream sKSerStream;
     cryptoContext->SerializeEvalSumKey(sKSerStream, defaultSerType);
-    channel->writeWithSize(sKSerStream.str());
-
 #ifdef VERBOSE
-    std::cout << "The sum keys have been sent:" << sKSerStream.str().size() << std::endl;
+    std::cout << "The sum keys have been sent:" << sKSerStream.size() << std::endl;
 #endif
+    channel->writeWithSize(sKSerStream.take());
 
     // Serialize Automorphism Keys
 
-    auto autoKSerStream = std::ostringstream();
+    StringOutStream autoKSerStream;
     cryptoContext->SerializeEvalAutomorphismKey(autoKSerStream, defaultSerType);
-    channel->writeWithSize(autoKSerStream.str());
-
 #ifdef VERBOSE
-    std::cout << "The automorphism keys have been sent:" << autoKSerStream.str().size() << std::endl;
+    std::cout << "The automorphism keys have been sent:" << autoKSerStream.size() << std::endl;
 #endif
+    channel->writeWithSize(autoKSerStream.take());
 }
 
 bool SimpleFHEPSIClient::receiveResult()
 {
     bool found = false;
+    vector<unsigned char> cipherVector;
     for (int i = 0; i < resultSize; i++)
     {
         lbcrypto::Ciphertext<FHEEncType> ciphertext;
-        vector<unsigned char> cipherVector;
         channel->readWithSizeIntoVector(cipherVector);
-        auto ctSS = std::istringstream(std::string(cipherVector.begin(), cipherVector.end()));
+        FrameInStream ctSS(cipherVector);
         lbcrypto::Serial::Deserialize(ciphertext, ctSS, defaultSerType);
         lbcrypto::Plaintext plaintext;
         cryptoContext->Decrypt(keyPair.secretKey, ciphertext, &plaintext);
@@ -24,6 +24,9 @@ private:
     vector<vector<indexFHEVectorType *>> encryptedCuckooIndexMatrices;
     int resultSize;
 
+    void sendRequests();
+    void receiveResults();
+
     inline std::string protocolName()
     {
         return "SimpleFHE";
@@ -8,11 +8,15 @@
 #include <chrono>
 #include <fstream>
 #include <ctime>
+#include <exception>
+#include <functional>
+#include <thread>
 #include "comm/Comm.hpp"
 #include <boost/thread/thread.hpp>
 #include "src/Common/DataInput/DataInputHandler.hpp"
 #include "src/Common/Parameter/PSIParameter.hpp"
 #include "src/Common/Utils.hpp"
+#include "src/Common/AsyncChannel.hpp"
 /**
  * @brief Abstract PSIClient object. Handles data i/o, communication and evaluation measurements.
  *
@@ -25,26 +29,19 @@ protected:
     DataInputHandler &dataIH; // To test if sets matches
     PSIParameter &clientParams;
     std::vector<biginteger> &clientSet;
-    shared_ptr<CommParty> channel;
+    shared_ptr<AsyncChannel> channel;
     vector<biginteger> intersectionCalculated;
-    boost::asio::io_service io_service;
     string protocolName;
-    // boost::thread t;
     string exportFileName;
 
     void connectToServer()
     {
-        // t = boost::thread(boost::bind(&boost::asio::io_service::run, &io_service));
-        auto client = SocketPartyData(boost_ip::address::from_string(clientParams.ip), clientParams.port);
-        auto server = SocketPartyData(boost_ip::address::from_string(clientParams.ip), clientParams.port + 1);
-        channel = make_shared<CommPartyTCPSynced>(io_service, client, server, 1);
-        channel->join(500, 5000000);
+        channel = AsyncChannel::connect(clientParams.ip, clientParams.port, 500, 5000000, clientParams.numberOfStreams);
     }
 
     void closeConnection()
     {
-        io_service.stop();
-        // t.join();
+        channel->close();
     }
 
     void readPhaseOverSignal()
@@ -53,6 +50,43 @@ protected:
         channel->readWithSizeIntoVector(signal);
     }
 
+    /**
+     * @brief Runs receive on its own thread while send runs on the calling one, so the results that the server streams
+     *        are read and decrypted while the last requests are still sent. Both must not share state that is not thread-safe.
+     *        Rethrows an exception of either side, if send throws, the channel is closed to stop the receiver.
+     */
+    void sendWhileReceiving(const std::function<void()> &send, std::function<void()> receive)
+    {
+        auto receiveError = make_shared<std::exception_ptr>();
+        std::thread receiver([receive, receiveError]
+                             {
+                                 try
+                                 {
+                                     receive();
+                                 }
+                                 catch (...)
+                                 {
+                                     *receiveError = std::current_exception();
+                                 } });
+        try
+        {
+            send();
+        }
+        catch (...)
+        {
+            // The receiver waits for results that will not come: closing the channel makes its read throw, so it can be
+            // joined before receive and the state it captures go out of scope. Its own exception is a consequence, not the cause.
+            channel->close();
+            receiver.join();
+            throw;
+        }
+        receiver.join();
+        if (*receiveError)
+        {
+            std::rethrow_exception(*receiveError);
+        }
+    }
+
 public:
     PSIClient(DataInputHandler &dataIH, PSIParameter &clientParams, string protocolName)
         : dataIH(dataIH), clientParams(clientParams), clientSet(dataIH.getClientSet()), protocolName(protocolName)
@@ -91,9 +125,7 @@ public:
         end = chrono::steady_clock::now();
         auto setUpTime = chrono::duration_cast<chrono::microseconds>(end - begin).count();
         cout << "Set up time = " << setUpTime << "[µs]" << endl;
-        PSIMeasurement setUpM(setUpTime, channel->bytesIn, channel->bytesOut);
-        channel->bytesIn = 0; // TODO: Care if used by other (communication thread)
-        channel->bytesOut = 0;
+        PSIMeasurement setUpM(setUpTime, channel->takeBytesIn(), channel->takeBytesOut());
 
         cout << "Run Offline" << endl;
         begin = chrono::steady_clock::now();
@@ -103,9 +135,7 @@ public:
         end = chrono::steady_clock::now();
         auto offlineTime = chrono::duration_cast<chrono::microseconds>(end - begin).count();
         cout << "Offline time = " << offlineTime << "[µs]" << endl;
-        PSIMeasurement offlineM(offlineTime, channel->bytesIn, channel->bytesOut);
-        channel->bytesIn = 0; // TODO: Care if used by other (communication thread)
-        channel->bytesOut = 0;
+        PSIMeasurement offlineM(offlineTime, channel->takeBytesIn(), channel->takeBytesOut());
 
         cout << "Run Online" << endl;
         begin = chrono::steady_clock::now();
@@ -113,7 +143,7 @@ public:
         end = chrono::steady_clock::now();
         auto onlineTime = chrono::duration_cast<chrono::microseconds>(end - begin).count();
         cout << "Online time = " << onlineTime << "[µs]" << endl;
-        PSIMeasurement onlineM(onlineTime, channel->bytesIn, channel->bytesOut);
+        PSIMeasurement onlineM(onlineTime, channel->takeBytesIn(), channel->takeBytesOut());
         closeConnection();
 
         if (intersectionMatches())
@@ -0,0 +1,496 @@
+/**
+ * @file AsyncChannel.cpp
+ *
+ * @version 0.1
+ *
+ */
+#include "AsyncChannel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+using boost::asio::ip::tcp;
+
+AsyncChannel::AsyncChannel(const std::string &ip, int port, bool listen, int retryIntervalMs, int64_t timeoutMs, size_t numberOfStreams,
+                           bool coalescing)
+    : coalescing(coalescing)
+{
+    if (numberOfStreams == 0 || numberOfStreams > UINT32_MAX)
+    {
+        throw std::invalid_argument("Number of streams must be positive");
+    }
+    for (size_t i = 0; i < numberOfStreams; i++)
+    {
+        streams.emplace_back(new Stream(ioService));
+    }
+
+    // Handshake of each connection: stream index and number of streams of the connecting party
+    uint32_t hello[2];
+    tcp::endpoint endpoint(boost::asio::ip::address::from_string(ip), port);
+    if (listen)
+    {
+        tcp::acceptor acceptor(ioService);
+        acceptor.open(endpoint.protocol());
+        acceptor.set_option(tcp::acceptor::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen();
+        std::vector<bool> accepted(numberOfStreams, false);
+        for (size_t i = 0; i < numberOfStreams; i++)
+        {
+            tcp::socket socket(ioService);
+            acceptor.accept(socket);
+            boost::asio::read(socket, boost::asio::buffer(hello, sizeof(hello)));
+            if (hello[1] != numberOfStreams || hello[0] >= numberOfStreams || accepted[hello[0]])
+            {
+                throw std::runtime_error("The other party uses " + std::to_string(hello[1]) + " streams instead of " +
+                                         std::to_string(numberOfStreams));
+            }
+            accepted[hello[0]] = true;
+            streams[hello[0]]->socket = std::move(socket);
+        }
+    }
+    else
+    {
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < numberOfStreams; i++)
+        {
+            tcp::socket &socket = streams[i]->socket;
+            boost::system::error_code ec;
+            while (socket.connect(endpoint, ec))
+            {
+                socket.close();
+                auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+                if (waited >= timeoutMs)
+                {
+                    throw std::runtime_error("Could not connect to " + ip + ":" + std::to_string(port) + ": " + ec.message());
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(retryIntervalMs));
+            }
+            hello[0] = i;
+            hello[1] = numberOfStreams;
+            boost::asio::write(socket, boost::asio::buffer(hello, sizeof(hello)));
+        }
+    }
+    for (auto &stream : streams)
+    {
+        // Many small messages (compare elements, bitvectors), do not wait for full segments
+        stream->socket.set_option(tcp::no_delay(true));
+    }
+}
+
+std::shared_ptr<AsyncChannel> AsyncChannel::accept(const std::string &ip, int port, size_t numberOfStreams, bool coalescing)
+{
+    std::shared_ptr<AsyncChannel> channel(new AsyncChannel(ip, port, true, 0, 0, numberOfStreams, coalescing));
+    channel->start();
+    return channel;
+}
+
+std::shared_ptr<AsyncChannel> AsyncChannel::connect(const std::string &ip, int port, int retryIntervalMs, int64_t timeoutMs,
+                                                    size_t numberOfStreams, bool coalescing)
+{
+    std::shared_ptr<AsyncChannel> channel(new AsyncChannel(ip, port, false, retryIntervalMs, timeoutMs, numberOfStreams, coalescing));
+    channel->start();
+    return channel;
+}
+
+AsyncChannel::~AsyncChannel()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void AsyncChannel::start()
+{
+    work.reset(new boost::asio::io_service::work(ioService));
+    for (auto &streamPointer : streams)
+    {
+        Stream &stream = *streamPointer;
+        stream.readBuffer.resize(coalescing ? readChunkBytes : sizeof(uint32_t));
+        stream.strand.post([this, &stream]
+                           { readNext(stream); });
+    }
+    // The strands keep the handlers of one stream sequential, the streams run in parallel
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        ioThreads.emplace_back([this]
+                               { ioService.run(); });
+    }
+}
+
+/**
+ * @brief Appends data to the send queue of the next stream, called under the lock.
+ * @param idleStreams collects the streams whose writing has to be started
+ */
+void AsyncChannel::queue(std::string &&data, std::vector<Stream *> &idleStreams)
+{
+    Stream &stream = *streams[nextSendStream];
+    nextSendStream = (nextSendStream + 1) % streams.size();
+    uint32_t size = data.size();
+    stream.sendQueue.push_back(OutMessage{size, std::move(data)});
+    bytesOut += sizeof(uint32_t) + size;
+    if (!stream.writing)
+    {
+        stream.writing = true;
+        idleStreams.push_back(&stream);
+    }
+}
+
+void AsyncChannel::startWriting(const std::vector<Stream *> &idleStreams)
+{
+    for (Stream *stream : idleStreams)
+    {
+        stream->strand.post([this, stream]
+                            { writeNext(*stream); });
+    }
+}
+
+void AsyncChannel::writeWithSize(std::string data)
+{
+    std::vector<Stream *> idleStreams;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error.empty())
+        {
+            throw std::runtime_error(error);
+        }
+        queue(std::move(data), idleStreams);
+    }
+    startWriting(idleStreams);
+}
+
+void AsyncChannel::writeBatch(std::vector<std::string> &&messages)
+{
+    std::vector<Stream *> idleStreams;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error.empty())
+        {
+            throw std::runtime_error(error);
+        }
+        for (auto &data : messages)
+        {
+            queue(std::move(data), idleStreams);
+        }
+    }
+    startWriting(idleStreams);
+}
+
+/**
+ * @brief Strand of stream: writes the messages at the front of its send queue with one gather operation. Producers only
+ *        append, so they stay in place.
+ */
+void AsyncChannel::writeNext(Stream &stream)
+{
+    stream.gatherBuffers.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t limit = coalescing ? maxGatherMessages : 1;
+        size_t gatherBytes = 0;
+        stream.writingMessages = 0;
+        while (stream.writingMessages < stream.sendQueue.size() && stream.writingMessages < limit &&
+               (stream.writingMessages == 0 || gatherBytes + stream.sendQueue[stream.writingMessages].data.size() <= maxGatherBytes))
+        {
+            OutMessage &message = stream.sendQueue[stream.writingMessages];
+            stream.gatherBuffers.push_back(boost::asio::buffer(&message.size, sizeof(uint32_t)));
+            stream.gatherBuffers.push_back(boost::asio::buffer(message.data));
+            gatherBytes += sizeof(uint32_t) + message.data.size();
+            stream.writingMessages++;
+        }
+    }
+    auto onWritten = [this, &stream](const boost::system::error_code &ec, size_t)
+    {
+        if (ec)
+        {
+            fail("Sending failed: ", ec);
+            return;
+        }
+        bool more;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stream.sendQueue.erase(stream.sendQueue.begin(), stream.sendQueue.begin() + stream.writingMessages);
+            more = !stream.sendQueue.empty();
+            stream.writing = more;
+        }
+        if (more)
+        {
+            writeNext(stream);
+        }
+        else
+        {
+            sendDone.notify_all();
+        }
+    };
+
+    writeOperations++;
+    boost::asio::async_write(stream.socket, stream.gatherBuffers, stream.strand.wrap(onWritten));
+}
+
+/**
+ * @brief Strand of stream: with coalescing, reads whatever arrived (up to readChunkBytes) and cuts it into messages.
+ *        Without, reads exactly the size field of the next message and then exactly its data.
+ */
+void AsyncChannel::readNext(Stream &stream)
+{
+    auto onRead = [this, &stream](const boost::system::error_code &ec, size_t received)
+    {
+        if (ec == boost::asio::error::eof && stream.inSizeBytes == 0 && stream.inMessage.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stream.peerClosed = true;
+            }
+            messageReceived.notify_all();
+            return;
+        }
+        if (ec)
+        {
+            fail("Receiving failed: ", ec);
+            return;
+        }
+        if (parse(stream, 0, received) > 0)
+        {
+            messageReceived.notify_all();
+        }
+        bool paused;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // A stream with nothing queued keeps reading, the reader may be waiting for its next message
+            paused = stream.readPaused = receiveQueueBytes > maxReceiveQueueBytes && !stream.receiveQueue.empty();
+        }
+        if (!paused)
+        {
+            readNext(stream);
+        }
+    };
+
+    readOperations++;
+    if (coalescing)
+    {
+        stream.socket.async_read_some(boost::asio::buffer(stream.readBuffer), stream.strand.wrap(onRead));
+    }
+    else if (stream.inSizeBytes < sizeof(uint32_t))
+    {
+        boost::asio::async_read(stream.socket, boost::asio::buffer(stream.readBuffer.data(), sizeof(uint32_t)), stream.strand.wrap(onRead));
+    }
+    else
+    {
+        // The data goes directly into inMessage, parse only has to queue it
+        auto onData = [onRead](const boost::system::error_code &ec, size_t)
+        { onRead(ec, 0); };
+        boost::asio::async_read(stream.socket, boost::asio::buffer(stream.inMessage), stream.strand.wrap(onData));
+    }
+}
+
+/**
+ * @brief Strand of stream: continues the message being received with readBuffer[position, end) and queues all completed messages.
+ * @return number of completed messages
+ */
+size_t AsyncChannel::parse(Stream &stream, size_t position, size_t end)
+{
+    size_t completed = 0;
+    while (true)
+    {
+        if (stream.inSizeBytes < sizeof(uint32_t))
+        {
+            size_t take = std::min(sizeof(uint32_t) - stream.inSizeBytes, end - position);
+            std::memcpy(reinterpret_cast<unsigned char *>(&stream.inSize) + stream.inSizeBytes, stream.readBuffer.data() + position, take);
+            stream.inSizeBytes += take;
+            position += take;
+            if (stream.inSizeBytes < sizeof(uint32_t))
+            {
+                return completed;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!freeBuffers.empty())
+            {
+                stream.inMessage.swap(freeBuffers.back());
+                freeBufferBytes -= stream.inMessage.capacity();
+                freeBuffers.pop_back();
+            }
+            if (stream.inMessage.capacity() < stream.inSize)
+            {
+                bufferAllocations++;
+            }
+            stream.inMessage.clear();
+            stream.inMessage.reserve(stream.inSize);
+            if (!coalescing)
+            {
+                stream.inMessage.resize(stream.inSize);
+            }
+        }
+
+        if (coalescing)
+        {
+            size_t take = std::min(size_t(stream.inSize) - stream.inMessage.size(), end - position);
+            stream.inMessage.insert(stream.inMessage.end(), stream.readBuffer.begin() + position, stream.readBuffer.begin() + position + take);
+            position += take;
+            if (stream.inMessage.size() < stream.inSize)
+            {
+                return completed;
+            }
+        }
+        else if (end > 0 && stream.inSize > 0)
+        {
+            // Only the size field was read, readNext reads the data into inMessage next
+            return completed;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            receiveQueueBytes += stream.inMessage.size();
+            stream.receiveQueue.push_back(std::move(stream.inMessage));
+        }
+        stream.inMessage = std::vector<unsigned char>();
+        stream.inSizeBytes = 0;
+        completed++;
+        if (position == end)
+        {
+            return completed;
+        }
+    }
+}
+
+void AsyncChannel::fail(const std::string &what, const boost::system::error_code &ec)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Closing the sockets aborts the pending reads, that is no error
+        if (error.empty() && ec != boost::asio::error::operation_aborted)
+        {
+            error = what + ec.message();
+        }
+        // A lost stream breaks the order of all others
+        for (auto &stream : streams)
+        {
+            stream->peerClosed = true;
+            stream->writing = false;
+        }
+    }
+    sendDone.notify_all();
+    messageReceived.notify_all();
+}
+
+/**
+ * @brief Under mutex: keeps buffer for the next received message, unless that exceeds maxFreeBufferBytes.
+ */
+void AsyncChannel::keepFreeBuffer(std::vector<unsigned char> &&buffer)
+{
+    if (buffer.capacity() > 0 && freeBufferBytes + buffer.capacity() <= maxFreeBufferBytes)
+    {
+        freeBufferBytes += buffer.capacity();
+        freeBuffers.push_back(std::move(buffer));
+    }
+}
+
+bool AsyncChannel::allWritten() const
+{
+    for (auto &stream : streams)
+    {
+        if (stream->writing)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t AsyncChannel::readWithSizeIntoVector(std::vector<unsigned char> &target)
+{
+    std::vector<Stream *> resumedStreams;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        Stream &stream = *streams[nextReceiveStream];
+        messageReceived.wait(lock, [&stream]
+                             { return !stream.receiveQueue.empty() || stream.peerClosed; });
+        if (stream.receiveQueue.empty())
+        {
+            throw std::runtime_error(error.empty() ? "Connection closed by the other party" : error);
+        }
+        nextReceiveStream = (nextReceiveStream + 1) % streams.size();
+        target.swap(stream.receiveQueue.front());
+        keepFreeBuffer(std::move(stream.receiveQueue.front()));
+        stream.receiveQueue.pop_front();
+        receiveQueueBytes -= target.size();
+        for (auto &paused : streams)
+        {
+            if (paused->readPaused && (receiveQueueBytes <= maxReceiveQueueBytes / 2 || paused->receiveQueue.empty()))
+            {
+                paused->readPaused = false;
+                resumedStreams.push_back(paused.get());
+            }
+        }
+    }
+    bytesIn += sizeof(uint32_t) + target.size();
+    for (Stream *stream : resumedStreams)
+    {
+        stream->strand.post([this, stream]
+                            { readNext(*stream); });
+    }
+    return target.size();
+}
+
+void AsyncChannel::recycle(std::vector<std::vector<unsigned char>> &frames)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &frame : frames)
+        {
+            keepFreeBuffer(std::move(frame));
+        }
+    }
+    std::vector<std::vector<unsigned char>>().swap(frames);
+}
+
+void AsyncChannel::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    sendDone.wait(lock, [this]
+                  { return allWritten(); });
+    if (!error.empty())
+    {
+        throw std::runtime_error(error);
+    }
+}
+
+void AsyncChannel::close()
+{
+    if (ioThreads.empty())
+    {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        sendDone.wait(lock, [this]
+                      { return allWritten(); });
+    }
+    for (auto &streamPointer : streams)
+    {
+        Stream &stream = *streamPointer;
+        stream.strand.post([&stream]
+                           {
+                               boost::system::error_code ec;
+                               stream.socket.shutdown(tcp::socket::shutdown_both, ec);
+                               stream.socket.close(ec); });
+    }
+    work.reset();
+    for (auto &ioThread : ioThreads)
+    {
+        ioThread.join();
+    }
+    ioThreads.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &stream : streams)
+        {
+            stream->peerClosed = true;
+        }
+    }
+    messageReceived.notify_all();
+    flush();
+}
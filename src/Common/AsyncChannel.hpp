@@ -0,0 +1,197 @@
+/**
+ * @file AsyncChannel.hpp
+ *
+ * @version 0.1
+ *
+ */
+#pragma once
+#include <atomic>
+#include <boost/asio.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Full-duplex TCP channel between the two PSI parties, driven by asio io threads.
+ *
+ * Messages are framed like CommParty::writeWithSize (4 byte size, then the data). writeWithSize only queues a message
+ * and returns, the io threads write the send queues in order. They also keep reading incoming messages into the
+ * receive queues, readWithSizeIntoVector takes the next one. A party can therefore send while it receives, and
+ * both directions stay busy while the PIEs compute.
+ *
+ * The framing stays per message, but not the system calls: the io threads coalesce all queued messages (up to
+ * maxGatherBytes) into one scatter/gather write and read large chunks, from which they cut the messages. Message
+ * buffers are recycled, i.e., a caller that passes the same vector to readWithSizeIntoVector again gets its buffer
+ * reused for a later message instead of a new allocation.
+ *
+ * A single TCP connection cannot fill a link with a high bandwidth-delay product, so a channel may consist of several
+ * connections (streams), each with its own io thread. Message k is sent on stream k % numberOfStreams and taken from
+ * the same stream on the other side, i.e., the messages are striped over the streams and still arrive in order. Both
+ * parties must use the same number of streams, the connecting party announces its number in the handshake.
+ *
+ * writeWithSize may be called from several threads, readWithSizeIntoVector from one thread at a time.
+ * Bytes are counted when a message is queued for sending and when it is taken from the receive queue, i.e., per
+ * application phase, independent of when the io threads actually move them.
+ */
+class AsyncChannel
+{
+private:
+    struct OutMessage
+    {
+        uint32_t size;
+        std::string data;
+    };
+
+    /**
+     * @brief One TCP connection with its send and receive queue, its handlers run on its strand.
+     */
+    struct Stream
+    {
+        boost::asio::ip::tcp::socket socket;
+        boost::asio::io_service::strand strand;
+
+        // Guarded by the channel mutex
+        std::deque<OutMessage> sendQueue; // the first writingMessages are being written
+        bool writing = false;
+        std::deque<std::vector<unsigned char>> receiveQueue;
+        bool readPaused = false;
+        bool peerClosed = false;
+
+        // Strand only
+        size_t writingMessages = 0;
+        std::vector<boost::asio::const_buffer> gatherBuffers;
+        std::vector<unsigned char> readBuffer;
+        size_t inSizeBytes = 0; // bytes of the size field of the current message received so far
+        uint32_t inSize;
+        std::vector<unsigned char> inMessage;
+
+        explicit Stream(boost::asio::io_service &ioService) : socket(ioService), strand(ioService) {}
+    };
+
+    boost::asio::io_service ioService;
+    std::unique_ptr<boost::asio::io_service::work> work;
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::vector<std::thread> ioThreads;
+    const bool coalescing;
+
+    std::mutex mutex;
+    std::condition_variable sendDone;
+    std::condition_variable messageReceived;
+    size_t nextSendStream = 0;
+    size_t nextReceiveStream = 0;
+    std::vector<std::vector<unsigned char>> freeBuffers; // handed back by readWithSizeIntoVector and recycle, reused for received messages
+    size_t freeBufferBytes = 0; // capacity of freeBuffers, at most maxFreeBufferBytes
+    size_t receiveQueueBytes = 0; // of all streams
+    std::string error; // first error of the io threads, empty if none
+
+    std::atomic<uint64_t> bytesIn{0};
+    std::atomic<uint64_t> bytesOut{0};
+    std::atomic<uint64_t> writeOperations{0};
+    std::atomic<uint64_t> readOperations{0};
+    std::atomic<uint64_t> bufferAllocations{0};
+
+    explicit AsyncChannel(const std::string &ip, int port, bool listen, int retryIntervalMs, int64_t timeoutMs, size_t numberOfStreams,
+                          bool coalescing);
+
+    void start();
+    void queue(std::string &&data, std::vector<Stream *> &idleStreams);
+    void startWriting(const std::vector<Stream *> &idleStreams);
+    void writeNext(Stream &stream);
+    void readNext(Stream &stream);
+    size_t parse(Stream &stream, size_t position, size_t end);
+    void fail(const std::string &what, const boost::system::error_code &ec);
+    bool allWritten() const;
+    void keepFreeBuffer(std::vector<unsigned char> &&buffer);
+
+public:
+    // Reading ahead pauses once this many received bytes are not yet taken, TCP then slows the sender down
+    static const size_t maxReceiveQueueBytes = 64 * 1024 * 1024;
+    // Bytes of queued messages that are written with one operation at most
+    static const size_t maxGatherBytes = 4 * 1024 * 1024;
+    // Messages written with one operation at most, each takes two buffers of the (limited) iovec
+    static const size_t maxGatherMessages = 256;
+    // Size of a read operation
+    static const size_t readChunkBytes = 256 * 1024;
+    // Capacity of the buffers kept for reuse, larger ones are freed
+    static const size_t maxFreeBufferBytes = maxReceiveQueueBytes;
+
+    /**
+     * @brief Waits for the other party on ip:port and accepts its numberOfStreams connections.
+     * @param coalescing if false, every message is written with its own operation and read with two (size, data),
+     *        as by CommParty. For measurements only.
+     */
+    static std::shared_ptr<AsyncChannel> accept(const std::string &ip, int port, size_t numberOfStreams = 1, bool coalescing = true);
+
+    /**
+     * @brief Opens numberOfStreams connections to the other party on ip:port, retries every retryIntervalMs until
+     *        timeoutMs has passed.
+     * @param coalescing see accept
+     */
+    static std::shared_ptr<AsyncChannel> connect(const std::string &ip, int port, int retryIntervalMs, int64_t timeoutMs,
+                                                 size_t numberOfStreams = 1, bool coalescing = true);
+
+    /**
+     * @brief Flushes the send queues and closes the connections.
+     */
+    ~AsyncChannel();
+
+    AsyncChannel(const AsyncChannel &) = delete;
+    AsyncChannel &operator=(const AsyncChannel &) = delete;
+
+    /**
+     * @brief Queues data as one message, thread-safe. Throws std::runtime_error if the connection failed.
+     */
+    void writeWithSize(std::string data);
+
+    /**
+     * @brief Queues all messages at once, i.e., in order and with one lock and wake-up per stream.
+     */
+    void writeBatch(std::vector<std::string> &&messages);
+
+    /**
+     * @brief Blocks until the next message has been received and swaps it into target, the former buffer of target is reused.
+     *        Throws std::runtime_error if the connection failed or the other party closed it before the message arrived.
+     * @return size of the message
+     */
+    size_t readWithSizeIntoVector(std::vector<unsigned char> &target);
+
+    /**
+     * @brief Hands the buffers of messages that have been decoded back for reuse by the next received messages and clears
+     *        frames, thread-safe. Without, every message of a fresh target is a new allocation.
+     */
+    void recycle(std::vector<std::vector<unsigned char>> &frames);
+
+    /**
+     * @brief Blocks until all queued messages have been handed to the sockets.
+     */
+    void flush();
+
+    /**
+     * @brief Flushes and closes the connections, the destructor calls it as well.
+     */
+    void close();
+
+    size_t getNumberOfStreams() const { return streams.size(); }
+
+    /**
+     * @brief Bytes sent and received since the last call (message sizes plus their 4 byte size fields), thread-safe.
+     */
+    uint64_t takeBytesIn() { return bytesIn.exchange(0); }
+    uint64_t takeBytesOut() { return bytesOut.exchange(0); }
+
+    /**
+     * @brief Number of write and read operations of the io threads so far, each about one system call.
+     */
+    uint64_t getWriteOperations() const { return writeOperations; }
+    uint64_t getReadOperations() const { return readOperations; }
+
+    /**
+     * @brief Number of received messages that did not fit into a reused buffer so far.
+     */
+    uint64_t getBufferAllocations() const { return bufferAllocations; }
+};
@@ -37,6 +37,233 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::completeEncryption(const shar
 	return make_shared<ElGamalOnGroupElementCiphertext>(c1, c2);
 }
 
+void AddHomElGamalEnc::enableNativeBackend(const string &curveName)
+{
+	nativeGroup = make_shared<NativeECGroup>(curveName);
+	nativeH.reset();
+	nativeHSource = nullptr;
+	nativeX.reset();
+	nativeXSource = nullptr;
+}
+
+void AddHomElGamalEnc::enableNativeValidation(const string &curveName)
+{
+	validationGroup = make_shared<NativeECGroup>(curveName);
+}
+
+AddHomElGamalEnc AddHomElGamalEnc::forkNative()
+{
+	if (!nativeGroup)
+	{
+		throw invalid_argument("Error, forking a cryptor requires the native backend");
+	}
+	AddHomElGamalEnc fork(*this);
+	fork.nativeGroup = make_shared<NativeECGroup>(nativeGroup->getCurveName());
+	fork.nativeGroup->setPippengerThreshold(nativeGroup->getPippengerThreshold());
+	return fork;
+}
+
+void AddHomElGamalEnc::generateNativeKey()
+{
+	if (!nativeGroup)
+	{
+		throw invalid_argument("Error, native keys require the native backend");
+	}
+	auto x = nativeGroup->randomScalar();
+	auto h = make_shared<NativeECPoint>(nativeGroup->newPoint());
+	nativeGroup->mulGenerator(*h, x.get());
+	publicKey.reset();
+	privateKey.reset();
+	nativeH = h;
+	nativeHSource = nullptr;
+	nativeX = shared_ptr<BIGNUM>(x.release(), BigNumDeleter());
+	nativeXSource = nullptr;
+}
+
+string AddHomElGamalEnc::getEncodedNativePublicKey()
+{
+	return nativeGroup->encode(getNativeH());
+}
+
+void AddHomElGamalEnc::setNativePublicKey(const string &encoded)
+{
+	if (!nativeGroup)
+	{
+		throw invalid_argument("Error, native keys require the native backend");
+	}
+	auto h = make_shared<NativeECPoint>(nativeGroup->newPoint());
+	nativeGroup->decode(*h, encoded, true);
+	publicKey.reset();
+	privateKey.reset();
+	nativeH = h;
+	nativeHSource = nullptr;
+	nativeX.reset();
+	nativeXSource = nullptr;
+}
+
+/**
+ * @brief Returns h of the current public key as native point, converted once per key.
+ * 		  Native keys have no libscapi key, they are kept as long as no libscapi key is set.
+ */
+const NativeECPoint &AddHomElGamalEnc::getNativeH()
+{
+	if (nativeH != nullptr && nativeHSource == publicKey.get())
+	{
+		return *nativeH;
+	}
+	if (publicKey == NULL)
+	{
+		throw KeyException("in order to encrypt a message this object must be initialized with public key");
+	}
+	nativeH = make_shared<NativeECPoint>(nativeGroup->newPoint());
+	toNativePoint(*nativeH, publicKey->getH().get());
+	nativeHSource = publicKey.get();
+	return *nativeH;
+}
+
+/**
+ * @brief Returns x of the current private key as native scalar, converted once per key.
+ */
+const BIGNUM *AddHomElGamalEnc::getNativeX()
+{
+	if (nativeX != nullptr && nativeXSource == privateKey.get())
+	{
+		return nativeX.get();
+	}
+	if (privateKey == NULL)
+	{
+		throw KeyException("in order to decrypt a message, this object must be initialized with private key");
+	}
+	nativeX = shared_ptr<BIGNUM>(nativeGroup->toScalar(privateKey->getX()).release(), BigNumDeleter());
+	nativeXSource = privateKey.get();
+	return nativeX.get();
+}
+
+void AddHomElGamalEnc::toNativePoint(NativeECPoint &nativePoint, GroupElement *element)
+{
+	auto ecElement = dynamic_cast<ECElement *>(element);
+	if (ecElement == NULL)
+	{
+		throw invalid_argument("native backend requires elliptic curve group elements");
+	}
+	nativeGroup->setAffine(nativePoint, ecElement->getX(), ecElement->getY(), false);
+}
+
+shared_ptr<GroupElement> AddHomElGamalEnc::toScapiElement(const NativeECPoint &nativePoint)
+{
+	if (dlog == nullptr)
+	{
+		throw invalid_argument("Error, " + nativeGroup->getCurveName() + " has no libscapi group");
+	}
+	if (nativeGroup->isInfinity(nativePoint))
+	{
+		return dlog->getIdentity();
+	}
+	auto coordinates = nativeGroup->getAffine(nativePoint);
+	vector<biginteger> values{coordinates.first, coordinates.second};
+	return dlog->generateElement(false, values);
+}
+
+/**
+ * @brief Returns cipher as native ciphertext. libscapi ciphertexts are converted into converted, which owns the result.
+ */
+NativeElGamalCiphertext *AddHomElGamalEnc::toNative(AsymmetricCiphertext *cipher, unique_ptr<NativeElGamalCiphertext> &converted)
+{
+	auto nativeCipher = dynamic_cast<NativeElGamalCiphertext *>(cipher);
+	if (nativeCipher != NULL)
+	{
+		return nativeCipher;
+	}
+
+	auto c = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher);
+	if (c == NULL)
+	{
+		throw invalid_argument("ciphertext should be instance of ElGamalCiphertext");
+	}
+	converted.reset(new NativeElGamalCiphertext(*nativeGroup));
+	toNativePoint(converted->u, c->getC1().get());
+	toNativePoint(converted->v, c->getC2().get());
+	return converted.get();
+}
+
+/**
+ * @brief result = g^exponent, taken from the generator power cache if possible.
+ */
+void AddHomElGamalEnc::nativeGeneratorPower(NativeECPoint &result, biginteger &exponent)
+{
+	if (generatorPowers && generatorPowers->lookUp(*nativeGroup, result, exponent))
+	{
+		return;
+	}
+	auto scalar = nativeGroup->toScalar(exponent);
+	nativeGroup->mulGenerator(result, scalar.get());
+}
+
+shared_ptr<GroupElement> AddHomElGamalEnc::generatorPower(biginteger &exponent)
+{
+	biginteger x, y;
+	if (generatorPowers && generatorPowers->lookUpAffine(exponent, x, y))
+	{
+		vector<biginteger> values{x, y};
+		return dlog->generateElement(false, values);
+	}
+	return dlog->exponentiateWithPreComputedValues(dlog->getGenerator(), exponent);
+}
+
+NativeElGamalCiphertext *AddHomElGamalEnc::newNativeCiphertext(CiphertextArena *arena)
+{
+	if (arena != nullptr)
+	{
+		return arena->acquireNative(*nativeGroup);
+	}
+	return new NativeElGamalCiphertext(*nativeGroup);
+}
+
+AsymmetricCiphertext *AddHomElGamalEnc::track(AsymmetricCiphertext *cipher, CiphertextArena *arena)
+{
+	if (arena != nullptr)
+	{
+		return arena->adopt(cipher);
+	}
+	return cipher;
+}
+
+shared_ptr<EncryptedZeroPool> AddHomElGamalEnc::newEncryptedZeroPool(size_t capacity)
+{
+	if (!nativeGroup)
+	{
+		throw invalid_argument("Error, the encrypted zero pool requires the native backend");
+	}
+	return make_shared<EncryptedZeroPool>(nativeGroup->getCurveName(), getNativeH(), capacity);
+}
+
+void AddHomElGamalEnc::drawEncryptedZeros(const vector<NativeElGamalCiphertext *> &targets)
+{
+	encryptedZeroPool->take(*nativeGroup, targets);
+}
+
+shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::encrypt(const shared_ptr<Plaintext> &plaintext)
+{
+	if (!nativeGroup)
+	{
+		return ElGamalEnc::encrypt(plaintext);
+	}
+
+	auto plain = dynamic_cast<BigIntegerPlainText *>(plaintext.get());
+	if (plain == NULL)
+	{
+		throw invalid_argument("plaintext should be instance of BigIntegerPlainText");
+	}
+
+	// u = g^r, v = g^m * h^r (one interleaved multiplication)
+	auto r = nativeGroup->randomScalar();
+	auto m = nativeGroup->toScalar(plain->getX());
+	auto cipher = make_shared<NativeElGamalCiphertext>(*nativeGroup);
+	nativeGroup->mulGenerator(cipher->u, r.get());
+	nativeGroup->mulGeneratorAndPoint(cipher->v, m.get(), getNativeH(), r.get());
+	return cipher;
+}
+
 /**
  * @brief Method to (slightly) improve encryption performance by using the secret key.
  *
@@ -45,6 +272,16 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::completeEncryption(const shar
  */
 shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::encryptWithSecretKey(biginteger &plaintext)
 {
+	if (nativeGroup)
+	{
+		// u = g^r, v = g^m * u^x
+		auto r = nativeGroup->randomScalar();
+		auto m = nativeGroup->toScalar(plaintext);
+		auto cipher = make_shared<NativeElGamalCiphertext>(*nativeGroup);
+		nativeGroup->mulGenerator(cipher->u, r.get());
+		nativeGroup->mulGeneratorAndPoint(cipher->v, m.get(), cipher->u, getNativeX());
+		return cipher;
+	}
 
 	// Currently not use, random element generation is inefficient
 	auto randomEl = dlog->createRandomElement();
@@ -91,6 +328,16 @@ shared_ptr<Plaintext> AddHomElGamalEnc::decrypt(AsymmetricCiphertext *cipher)
 	 *		Calculate m = ciphertext.getC2() * s
 	 */
 
+	if (nativeGroup)
+	{
+		unique_ptr<NativeElGamalCiphertext> converted;
+		auto c = toNative(cipher, converted);
+		NativeECPoint m = nativeGroup->newPoint();
+		nativeGroup->mul(m, c->u, getNativeX());
+		nativeGroup->subtract(m, c->v, m);
+		return make_shared<GroupElementPlaintext>(toScapiElement(m));
+	}
+
 	// If there is no private key, throws exception.
 	if (privateKey == NULL)
 	{
@@ -141,6 +388,13 @@ vector<byte> AddHomElGamalEnc::generateBytesFromPlaintext(Plaintext *plaintext)
  */
 shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::getAdditiveNeutral()
 {
+	if (nativeGroup)
+	{
+		auto neutral = make_shared<NativeElGamalCiphertext>(*nativeGroup);
+		nativeGroup->copy(neutral->u, nativeGroup->getGenerator());
+		nativeGroup->copy(neutral->v, getNativeH());
+		return neutral;
+	}
 
 	auto u = dlog->getGenerator();
 	auto v = dynamic_cast<ElGamalPublicKey *>(getPublicKey().get())->getH();
@@ -158,6 +412,10 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::getAdditiveNeutral()
  */
 shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::add(AsymmetricCiphertext *cipher1, AsymmetricCiphertext *cipher2)
 {
+	if (nativeGroup)
+	{
+		return shared_ptr<AsymmetricCiphertext>(addPointer(cipher1, cipher2));
+	}
 
 	auto c1 = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher1);
 	auto c2 = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher2);
@@ -205,8 +463,18 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::add(AsymmetricCiphertext *cip
  * @param cipher2
  * @return AsymmetricCiphertext*
  */
-AsymmetricCiphertext *AddHomElGamalEnc::addPointer(AsymmetricCiphertext *cipher1, AsymmetricCiphertext *cipher2)
+AsymmetricCiphertext *AddHomElGamalEnc::addPointer(AsymmetricCiphertext *cipher1, AsymmetricCiphertext *cipher2, CiphertextArena *arena)
 {
+	if (nativeGroup)
+	{
+		unique_ptr<NativeElGamalCiphertext> converted1, converted2;
+		auto c1 = toNative(cipher1, converted1);
+		auto c2 = toNative(cipher2, converted2);
+		auto result = newNativeCiphertext(arena);
+		nativeGroup->add(result->u, c1->u, c2->u);
+		nativeGroup->add(result->v, c1->v, c2->v);
+		return result;
+	}
 
 	auto c1 = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher1);
 	auto c2 = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher2);
@@ -244,7 +512,7 @@ AsymmetricCiphertext *AddHomElGamalEnc::addPointer(AsymmetricCiphertext *cipher1
 	// auto hExpWmultV1 = dlog->multiplyGroupElements(hExpW.get(), v1);
 	auto v = dlog->multiplyGroupElements(v1, v2);
 
-	return new ElGamalOnGroupElementCiphertext(u, v);
+	return track(new ElGamalOnGroupElementCiphertext(u, v), arena);
 }
 /**
  * Calculates the ciphertext resulting of adding two given ciphertexts.<P>
@@ -276,6 +544,11 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::add(AsymmetricCiphertext *cip
 	// 	throw new IllegalStateException("in order to encrypt a message this object must be initialized with public key");
 	// }
 
+	if (nativeGroup)
+	{
+		return shared_ptr<AsymmetricCiphertext>(addPointer(cipher1, cipher2));
+	}
+
 	auto c1 = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher1);
 	auto c2 = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher2);
 
@@ -324,6 +597,17 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::add(AsymmetricCiphertext *cip
  */
 shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::subtract(AsymmetricCiphertext *cipher1, AsymmetricCiphertext *cipher2)
 {
+	if (nativeGroup)
+	{
+		unique_ptr<NativeElGamalCiphertext> converted1, converted2;
+		auto c1 = toNative(cipher1, converted1);
+		auto c2 = toNative(cipher2, converted2);
+		auto result = make_shared<NativeElGamalCiphertext>(*nativeGroup);
+		nativeGroup->subtract(result->u, c1->u, c2->u);
+		nativeGroup->subtract(result->v, c1->v, c2->v);
+		return result;
+	}
+
 	auto c1 = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher1);
 	auto u1 = c1->getC1().get();
 	auto v1 = c1->getC2().get();
@@ -338,6 +622,139 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::subtract(AsymmetricCiphertext
 	return make_shared<ElGamalOnGroupElementCiphertext>(u, v);
 }
 
+void AddHomElGamalEnc::addInPlace(AsymmetricCiphertext *accumulator, AsymmetricCiphertext *cipher)
+{
+	auto nativeAcc = dynamic_cast<NativeElGamalCiphertext *>(accumulator);
+	if (nativeGroup && nativeAcc != NULL)
+	{
+		unique_ptr<NativeElGamalCiphertext> converted;
+		addInPlace(*nativeAcc, *toNative(cipher, converted));
+		return;
+	}
+
+	auto acc = dynamic_cast<ElGamalOnGroupElementCiphertext *>(accumulator);
+	auto c = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher);
+	if (acc == NULL || c == NULL)
+	{
+		throw invalid_argument("ciphertexts should be instance of ElGamalCiphertext");
+	}
+	*acc = ElGamalOnGroupElementCiphertext(dlog->multiplyGroupElements(acc->getC1().get(), c->getC1().get()),
+										   dlog->multiplyGroupElements(acc->getC2().get(), c->getC2().get()));
+}
+
+void AddHomElGamalEnc::subInPlace(AsymmetricCiphertext *accumulator, AsymmetricCiphertext *cipher)
+{
+	auto nativeAcc = dynamic_cast<NativeElGamalCiphertext *>(accumulator);
+	if (nativeGroup && nativeAcc != NULL)
+	{
+		unique_ptr<NativeElGamalCiphertext> converted;
+		auto c = toNative(cipher, converted);
+		nativeGroup->subtract(nativeAcc->u, nativeAcc->u, c->u);
+		nativeGroup->subtract(nativeAcc->v, nativeAcc->v, c->v);
+		return;
+	}
+
+	auto acc = dynamic_cast<ElGamalOnGroupElementCiphertext *>(accumulator);
+	auto c = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher);
+	if (acc == NULL || c == NULL)
+	{
+		throw invalid_argument("ciphertexts should be instance of ElGamalCiphertext");
+	}
+	auto u2Inv = dlog->getInverse(c->getC1().get());
+	auto v2Inv = dlog->getInverse(c->getC2().get());
+	*acc = ElGamalOnGroupElementCiphertext(dlog->multiplyGroupElements(acc->getC1().get(), u2Inv.get()),
+										   dlog->multiplyGroupElements(acc->getC2().get(), v2Inv.get()));
+}
+
+void AddHomElGamalEnc::multByConstInPlace(AsymmetricCiphertext *accumulator, biginteger &constNumber)
+{
+	auto nativeAcc = dynamic_cast<NativeElGamalCiphertext *>(accumulator);
+	if (nativeGroup && nativeAcc != NULL)
+	{
+		auto scalar = nativeGroup->toScalar(constNumber);
+		nativeGroup->mulInPlace(nativeAcc->u, scalar.get());
+		nativeGroup->mulInPlace(nativeAcc->v, scalar.get());
+		return;
+	}
+
+	auto acc = dynamic_cast<ElGamalOnGroupElementCiphertext *>(accumulator);
+	if (acc == NULL)
+	{
+		throw invalid_argument("ciphertext should be instance of ElGamalCiphertext");
+	}
+	*acc = ElGamalOnGroupElementCiphertext(dlog->exponentiate(acc->getC1().get(), constNumber),
+										   dlog->exponentiate(acc->getC2().get(), constNumber));
+}
+
+void AddHomElGamalEnc::normalize(AsymmetricCiphertext *cipher)
+{
+	auto nativeCipher = dynamic_cast<NativeElGamalCiphertext *>(cipher);
+	if (nativeGroup && nativeCipher != NULL)
+	{
+		normalize(*nativeCipher);
+	}
+}
+
+void AddHomElGamalEnc::normalizeBatch(const vector<AsymmetricCiphertext *> &ciphers)
+{
+	if (!nativeGroup)
+	{
+		return;
+	}
+
+	vector<EC_POINT *> points;
+	points.reserve(2 * ciphers.size());
+	for (auto cipher : ciphers)
+	{
+		auto nativeCipher = dynamic_cast<NativeElGamalCiphertext *>(cipher);
+		if (nativeCipher != NULL)
+		{
+			points.push_back(nativeCipher->u.get());
+			points.push_back(nativeCipher->v.get());
+		}
+	}
+	nativeGroup->normalize(points);
+}
+
+void AddHomElGamalEnc::normalizeBatch(const vector<shared_ptr<AsymmetricCiphertext>> &ciphers)
+{
+	vector<AsymmetricCiphertext *> rawCiphers(ciphers.size());
+	for (size_t i = 0; i < ciphers.size(); i++)
+	{
+		rawCiphers[i] = ciphers[i].get();
+	}
+	normalizeBatch(rawCiphers);
+}
+
+string AddHomElGamalEnc::encodeCiphertext(AsymmetricCiphertext *cipher)
+{
+	auto nativeCipher = dynamic_cast<NativeElGamalCiphertext *>(cipher);
+	if (nativeGroup && nativeCipher != NULL)
+	{
+		return nativeGroup->encode(nativeCipher->u) + ":" + nativeGroup->encode(nativeCipher->v);
+	}
+	return cipher->generateSendableData()->toString();
+}
+
+AsymmetricCiphertext *AddHomElGamalEnc::copyPointer(AsymmetricCiphertext *cipher, CiphertextArena *arena)
+{
+	if (nativeGroup)
+	{
+		unique_ptr<NativeElGamalCiphertext> converted;
+		auto result = newNativeCiphertext(arena);
+		copy(*result, *toNative(cipher, converted));
+		return result;
+	}
+
+	auto c = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher);
+	if (c == NULL)
+	{
+		throw invalid_argument("ciphertext should be instance of ElGamalCiphertext");
+	}
+	// Group elements are immutable and can be shared
+	return track(new ElGamalOnGroupElementCiphertext(c->getC1(), c->getC2()), arena);
+}
+
 /**
  * Receives a cipher and a constant number and returns their multiplication.
  * @return the multiplication result.
@@ -348,6 +765,10 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::multByConst(AsymmetricCiphert
 {
 	// Highly Simplifies! Normally use additional randomness
 	// biginteger w = getRandomInRange(0, qMinusOne, random.get());
+	if (nativeGroup)
+	{
+		return shared_ptr<AsymmetricCiphertext>(multByConstPointer(cipher, constNumber));
+	}
 	auto c1 = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher);
 
 	// Calculates u = u1^c.
@@ -387,6 +808,11 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::multByConst(AsymmetricCiphert
 	// 	throw new IllegalStateException("in order to encrypt a message this object must be initialized with public key");
 	// }
 
+	if (nativeGroup)
+	{
+		return shared_ptr<AsymmetricCiphertext>(multByConstPointer(cipher, constNumber));
+	}
+
 	auto c1 = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher);
 
 	// Cipher1 and cipher2 should be ElGamal ciphertexts.
@@ -430,8 +856,15 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::multByConst(AsymmetricCiphert
  * @param constNumber
  * @return AsymmetricCiphertext*
  */
-AsymmetricCiphertext *AddHomElGamalEnc::multByConstPointer(AsymmetricCiphertext *cipher, biginteger &constNumber)
+AsymmetricCiphertext *AddHomElGamalEnc::multByConstPointer(AsymmetricCiphertext *cipher, biginteger &constNumber, CiphertextArena *arena)
 {
+	if (nativeGroup)
+	{
+		unique_ptr<NativeElGamalCiphertext> converted;
+		auto result = newNativeCiphertext(arena);
+		multByConst(*result, *toNative(cipher, converted), constNumber);
+		return result;
+	}
 
 	auto c1 = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher);
 
@@ -445,7 +878,7 @@ AsymmetricCiphertext *AddHomElGamalEnc::multByConstPointer(AsymmetricCiphertext
 	auto v = dlog->exponentiate(c1->getC2().get(), constNumber);
 	// auto v = dlog->multiplyGroupElements(hExpW.get(), hExpWmultV1.get());
 
-	return new ElGamalOnGroupElementCiphertext(u, v);
+	return track(new ElGamalOnGroupElementCiphertext(u, v), arena);
 }
 /**
  * @brief If elem is encrypted, outputs encryption of 0, if 0 is encrypted outputs encryption of elem.
@@ -455,8 +888,15 @@ AsymmetricCiphertext *AddHomElGamalEnc::multByConstPointer(AsymmetricCiphertext
  * @param elem
  * @return AsymmetricCiphertext*
  */
-AsymmetricCiphertext *AddHomElGamalEnc::elementXorByConstPointer(AsymmetricCiphertext *cipher, biginteger &elem)
+AsymmetricCiphertext *AddHomElGamalEnc::elementXorByConstPointer(AsymmetricCiphertext *cipher, biginteger &elem, CiphertextArena *arena)
 {
+	if (nativeGroup)
+	{
+		unique_ptr<NativeElGamalCiphertext> converted;
+		auto result = newNativeCiphertext(arena);
+		elementXorByConst(*result, *toNative(cipher, converted), elem);
+		return result;
+	}
 
 	// if (!ElGamalEnc::isKeySet())
 	// {
@@ -485,12 +925,12 @@ AsymmetricCiphertext *AddHomElGamalEnc::elementXorByConstPointer(AsymmetricCiphe
 	//  	throw invalid_argument("the given random value must be in Zq");
 	//  }
 
-	std::shared_ptr<GroupElement> add = dlog->exponentiateWithPreComputedValues(dlog->getGenerator(), elem);
+	std::shared_ptr<GroupElement> add = generatorPower(elem);
 
 	auto u = dlog->getInverse(u1);
 	auto v = dlog->multiplyGroupElements(dlog->getInverse(v1).get(), add.get());
 
-	return new ElGamalOnGroupElementCiphertext(u, v);
+	return track(new ElGamalOnGroupElementCiphertext(u, v), arena);
 }
 
 /**
@@ -503,6 +943,21 @@ AsymmetricCiphertext *AddHomElGamalEnc::elementXorByConstPointer(AsymmetricCiphe
 shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::xorByConst(AsymmetricCiphertext *cipher, bool constBool)
 {
 	// Assume that ciphertext ecrypts 0 or 1
+	if (nativeGroup)
+	{
+		unique_ptr<NativeElGamalCiphertext> converted;
+		auto c = toNative(cipher, converted);
+		auto result = make_shared<NativeElGamalCiphertext>(*nativeGroup);
+		nativeGroup->copy(result->u, c->u);
+		nativeGroup->copy(result->v, c->v);
+		if (constBool)
+		{
+			// u = u1^-1, v = v1^-1 * g
+			nativeGroup->invert(result->u);
+			nativeGroup->subtract(result->v, nativeGroup->getGenerator(), c->v);
+		}
+		return result;
+	}
 
 	// if (!ElGamalEnc::isKeySet())
 	// {
@@ -544,6 +999,10 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::xorByConst(AsymmetricCipherte
 
 shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::homomorphicInnerProduct(vector<AsymmetricCiphertext *> &indexVector, vector<biginteger> &plaintextVector)
 {
+	if (nativeGroup)
+	{
+		return nativeInnerProduct(indexVector, plaintextVector, {});
+	}
 
 	vector<shared_ptr<GroupElement>> uVector(indexVector.size());
 	vector<shared_ptr<GroupElement>> vVector(indexVector.size());
@@ -565,23 +1024,44 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::homomorphicInnerProduct(vecto
 	return make_shared<ElGamalOnGroupElementCiphertext>(u, v);
 }
 
+/**
+ * @brief Random exponent in [1, q-1], from the native group if enabled (which may have no libscapi counterpart).
+ */
+biginteger AddHomElGamalEnc::randomExponent()
+{
+	if (nativeGroup)
+	{
+		return bnToBiginteger(nativeGroup->randomScalar().get());
+	}
+	return getRandomInRange(1, qMinusOne, random.get());
+}
+
 shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::randomizedEquality(AsymmetricCiphertext *minusCompareElement, AsymmetricCiphertext *secondCompareElement, AsymmetricCiphertext *encryptedZero)
 {
 
-	biginteger r = getRandomInRange(1, qMinusOne, random.get());
+	biginteger r = randomExponent();
 
 	auto ciphertext = add(minusCompareElement, secondCompareElement);
-	ciphertext = add(ciphertext.get(), encryptedZero);
-	return multByConst(ciphertext.get(), r);
+	addInPlace(ciphertext.get(), encryptedZero);
+	multByConstInPlace(ciphertext.get(), r);
+	return ciphertext;
 }
 
 shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::randomizedEquality(AsymmetricCiphertext *minusCompareElement, biginteger &plaintext, AsymmetricCiphertext *encryptedZero)
 {
+	if (nativeGroup)
+	{
+		unique_ptr<NativeElGamalCiphertext> converted;
+		auto result = make_shared<NativeElGamalCiphertext>(*nativeGroup);
+		randomizedEquality(*result, *toNative(minusCompareElement, converted), plaintext);
+		return result;
+	}
+
 	auto c = dynamic_cast<ElGamalOnGroupElementCiphertext *>(minusCompareElement);
 
 	biginteger r = getRandomInRange(1, qMinusOne, random.get());
 
-	auto gExpPlain = dlog->exponentiateWithPreComputedValues(dlog->getGenerator(), plaintext);
+	auto gExpPlain = generatorPower(plaintext);
 	auto vTemp = dlog->multiplyGroupElements(gExpPlain.get(), c->getC2().get());
 	auto v = dlog->exponentiate(vTemp.get(), r);
 	auto u = dlog->exponentiate(c->getC1().get(), r);
@@ -599,12 +1079,83 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::indexedRandomizedEquality(vec
 	return randomizedEquality(indexedElement.get(), minusCompareElement, encryptedZero);
 }
 
+bool AddHomElGamalEnc::buildIndexTables(NativeIndexTables &tables, vector<AsymmetricCiphertext *> &indexVector, int scalarBits, unsigned int windowSize)
+{
+	if (!nativeGroup)
+	{
+		return false;
+	}
+
+	vector<unique_ptr<NativeElGamalCiphertext>> converted(indexVector.size());
+	vector<NativeElGamalCiphertext *> nativeIndexVector(indexVector.size());
+	for (size_t i = 0; i < indexVector.size(); i++)
+	{
+		nativeIndexVector[i] = toNative(indexVector[i], converted[i]);
+	}
+	return buildIndexTables(tables, nativeIndexVector, scalarBits, windowSize);
+}
+
+bool AddHomElGamalEnc::recodePlaintexts(NativeRecodedScalars &recoded, vector<biginteger> &plaintextVector, int scalarBits, unsigned int windowSize)
+{
+	if (!nativeGroup)
+	{
+		return false;
+	}
+
+	vector<BigNumPtr> scalarStorage(plaintextVector.size());
+	vector<const BIGNUM *> scalars(plaintextVector.size());
+	for (size_t i = 0; i < plaintextVector.size(); i++)
+	{
+		scalarStorage[i] = nativeGroup->toScalar(plaintextVector[i]);
+		scalars[i] = scalarStorage[i].get();
+	}
+	NativeECGroup::recodeScalars(recoded, scalars, scalarBits, windowSize);
+	return true;
+}
+
+shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::tabledIndexedRandomizedEquality(const NativeIndexTables &tables,
+																				   vector<biginteger> &plaintextVector,
+																				   AsymmetricCiphertext *minusCompareElement,
+																				   AsymmetricCiphertext *encryptedZero)
+{
+	if (!nativeGroup || tables.uTables.empty())
+	{
+		throw invalid_argument("Error, index tables require the native backend");
+	}
+
+	auto &shape = tables.uTables[0];
+	NativeRecodedScalars recoded;
+	recodePlaintexts(recoded, plaintextVector, int((shape.numberOfWindows - 1) * shape.windowSize), shape.windowSize);
+	return tabledIndexedRandomizedEquality(tables, recoded, minusCompareElement, encryptedZero);
+}
+
+shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::tabledIndexedRandomizedEquality(const NativeIndexTables &tables,
+																				   const NativeRecodedScalars &recodedPlaintexts,
+																				   AsymmetricCiphertext *minusCompareElement,
+																				   AsymmetricCiphertext *encryptedZero)
+{
+	if (!nativeGroup)
+	{
+		throw invalid_argument("Error, index tables require the native backend");
+	}
+
+	unique_ptr<NativeElGamalCiphertext> convertedCompare, convertedZero;
+	auto ciphertext = make_shared<NativeElGamalCiphertext>(*nativeGroup);
+	tabledIndexedRandomizedEquality(*ciphertext, tables, recodedPlaintexts, *toNative(minusCompareElement, convertedCompare),
+									*toNative(encryptedZero, convertedZero));
+	return ciphertext;
+}
+
 shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::customIndexedRandomizedEquality(vector<AsymmetricCiphertext *> &indexVector,
 																				   vector<biginteger> &plaintextVector,
 																				   AsymmetricCiphertext *minusCompareElement,
 																				   AsymmetricCiphertext *encryptedZero,
 																				   biginteger &randomness)
 {
+	if (nativeGroup)
+	{
+		return nativeInnerProduct(indexVector, plaintextVector, {make_pair(minusCompareElement, randomness), make_pair(encryptedZero, biginteger(1))});
+	}
 
 	vector<shared_ptr<GroupElement>> uVector(indexVector.size() + 2);
 	vector<shared_ptr<GroupElement>> vVector(indexVector.size() + 2);
@@ -636,8 +1187,187 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::customIndexedRandomizedEquali
 	return make_shared<ElGamalOnGroupElementCiphertext>(u, v);
 }
 
+/**
+ * @brief Native multi-exponentiation prod_i c_i^p_i over the index ciphertexts and the additional (ciphertext, exponent) terms.
+ */
+shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::nativeInnerProduct(vector<AsymmetricCiphertext *> &indexVector, vector<biginteger> &plaintextVector,
+																	   const vector<pair<AsymmetricCiphertext *, biginteger>> &additionalTerms)
+{
+	vector<unique_ptr<NativeElGamalCiphertext>> converted(indexVector.size() + additionalTerms.size());
+	vector<NativeElGamalCiphertext *> nativeIndexVector(indexVector.size());
+	for (size_t i = 0; i < indexVector.size(); i++)
+	{
+		nativeIndexVector[i] = toNative(indexVector[i], converted[i]);
+	}
+	vector<pair<const NativeElGamalCiphertext *, biginteger>> nativeTerms;
+	for (size_t i = 0; i < additionalTerms.size(); i++)
+	{
+		nativeTerms.emplace_back(toNative(additionalTerms[i].first, converted[indexVector.size() + i]), additionalTerms[i].second);
+	}
+
+	auto result = make_shared<NativeElGamalCiphertext>(*nativeGroup);
+	nativeInnerProduct(*result, nativeIndexVector, plaintextVector, nativeTerms);
+	return result;
+}
+
+void AddHomElGamalEnc::nativeInnerProduct(NativeElGamalCiphertext &result, const vector<NativeElGamalCiphertext *> &indexVector,
+										  vector<biginteger> &plaintextVector,
+										  const vector<pair<const NativeElGamalCiphertext *, biginteger>> &additionalTerms)
+{
+	size_t n = indexVector.size() + additionalTerms.size();
+	scratchUPoints.resize(n);
+	scratchVPoints.resize(n);
+	vector<BigNumPtr> scalarStorage(n);
+	scratchScalars.resize(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		bool isIndex = i < indexVector.size();
+		const NativeElGamalCiphertext *c = isIndex ? indexVector[i] : additionalTerms[i - indexVector.size()].first;
+		scalarStorage[i] = nativeGroup->toScalar(isIndex ? plaintextVector[i] : additionalTerms[i - indexVector.size()].second);
+		scratchUPoints[i] = c->u.get();
+		scratchVPoints[i] = c->v.get();
+		scratchScalars[i] = scalarStorage[i].get();
+	}
+	nativeGroup->multiMulPair(result.u, result.v, scratchUPoints, scratchVPoints, scratchScalars);
+}
+
+void AddHomElGamalEnc::copy(NativeElGamalCiphertext &result, const NativeElGamalCiphertext &cipher)
+{
+	nativeGroup->copy(result.u, cipher.u);
+	nativeGroup->copy(result.v, cipher.v);
+}
+
+void AddHomElGamalEnc::addInPlace(NativeElGamalCiphertext &accumulator, const NativeElGamalCiphertext &cipher)
+{
+	nativeGroup->add(accumulator.u, accumulator.u, cipher.u);
+	nativeGroup->add(accumulator.v, accumulator.v, cipher.v);
+}
+
+void AddHomElGamalEnc::multByConst(NativeElGamalCiphertext &result, const NativeElGamalCiphertext &cipher, biginteger &constNumber)
+{
+	auto scalar = nativeGroup->toScalar(constNumber);
+	nativeGroup->mul(result.u, cipher.u, scalar.get());
+	nativeGroup->mul(result.v, cipher.v, scalar.get());
+}
+
+void AddHomElGamalEnc::elementXorByConst(NativeElGamalCiphertext &result, const NativeElGamalCiphertext &cipher, biginteger &elem)
+{
+	// u = u1^-1, v = v1^-1 * g^elem
+	nativeGroup->copy(result.u, cipher.u);
+	nativeGroup->invert(result.u);
+	nativeGeneratorPower(result.v, elem);
+	nativeGroup->subtract(result.v, result.v, cipher.v);
+}
+
+void AddHomElGamalEnc::normalize(NativeElGamalCiphertext &cipher)
+{
+	vector<EC_POINT *> points{cipher.u.get(), cipher.v.get()};
+	nativeGroup->normalize(points);
+}
+
+void AddHomElGamalEnc::randomizedEquality(NativeElGamalCiphertext &result, const NativeElGamalCiphertext &minusCompareElement,
+										  const NativeElGamalCiphertext &secondCompareElement, const NativeElGamalCiphertext &encryptedZero)
+{
+	auto r = nativeGroup->randomScalar();
+	nativeGroup->add(result.u, minusCompareElement.u, secondCompareElement.u);
+	nativeGroup->add(result.v, minusCompareElement.v, secondCompareElement.v);
+	addInPlace(result, encryptedZero);
+	nativeGroup->mulInPlace(result.u, r.get());
+	nativeGroup->mulInPlace(result.v, r.get());
+}
+
+void AddHomElGamalEnc::randomizedEquality(NativeElGamalCiphertext &result, const NativeElGamalCiphertext &minusCompareElement, biginteger &plaintext)
+{
+	// u = u1^r, v = (g^plaintext * v1)^r = g^(plaintext * r) * v1^r
+	auto r = nativeGroup->randomScalar();
+	if (generatorPowers && generatorPowers->lookUp(*nativeGroup, result.v, plaintext))
+	{
+		// v = (g^plaintext * v1)^r with the cached g^plaintext
+		nativeGroup->add(result.v, result.v, minusCompareElement.v);
+		nativeGroup->mulInPlace(result.v, r.get());
+		nativeGroup->mul(result.u, minusCompareElement.u, r.get());
+		return;
+	}
+	auto gScalar = nativeGroup->toScalar(plaintext);
+	BN_mod_mul(gScalar.get(), gScalar.get(), r.get(), nativeGroup->getOrder(), nativeGroup->getCTX());
+	nativeGroup->mul(result.u, minusCompareElement.u, r.get());
+	nativeGroup->mulGeneratorAndPoint(result.v, gScalar.get(), minusCompareElement.v, r.get());
+}
+
+void AddHomElGamalEnc::indexedRandomizedEquality(NativeElGamalCiphertext &result, const vector<NativeElGamalCiphertext *> &indexVector,
+												 vector<biginteger> &plaintextVector, const NativeElGamalCiphertext &minusCompareElement,
+												 const NativeElGamalCiphertext &encryptedZero)
+{
+	nativeInnerProduct(result, indexVector, plaintextVector, {});
+
+	auto r = nativeGroup->randomScalar();
+	addInPlace(result, minusCompareElement);
+	addInPlace(result, encryptedZero);
+	nativeGroup->mulInPlace(result.u, r.get());
+	nativeGroup->mulInPlace(result.v, r.get());
+}
+
+bool AddHomElGamalEnc::buildIndexTables(NativeIndexTables &tables, const vector<NativeElGamalCiphertext *> &indexVector, int scalarBits, unsigned int windowSize)
+{
+	if (!nativeGroup)
+	{
+		return false;
+	}
+
+	tables.uTables.resize(indexVector.size());
+	tables.vTables.resize(indexVector.size());
+	for (size_t i = 0; i < indexVector.size(); i++)
+	{
+		nativeGroup->buildWindowTable(tables.uTables[i], indexVector[i]->u, scalarBits, windowSize);
+		nativeGroup->buildWindowTable(tables.vTables[i], indexVector[i]->v, scalarBits, windowSize);
+	}
+	return true;
+}
+
+void AddHomElGamalEnc::tabledIndexedRandomizedEquality(NativeElGamalCiphertext &result, const NativeIndexTables &tables,
+													   const NativeRecodedScalars &recodedPlaintexts, const NativeElGamalCiphertext &minusCompareElement,
+													   const NativeElGamalCiphertext &encryptedZero)
+{
+	if (tables.uTables.size() != recodedPlaintexts.size())
+	{
+		throw invalid_argument("Error, index tables and plaintext vector differ in size");
+	}
+
+	size_t n = recodedPlaintexts.size();
+	scratchUTables.resize(n);
+	scratchVTables.resize(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		scratchUTables[i] = &tables.uTables[i];
+		scratchVTables[i] = &tables.vTables[i];
+	}
+	nativeGroup->multiMulPairWithTables(result.u, result.v, scratchUTables, scratchVTables, recodedPlaintexts);
+
+	auto r = nativeGroup->randomScalar();
+	addInPlace(result, minusCompareElement);
+	addInPlace(result, encryptedZero);
+	nativeGroup->mulInPlace(result.u, r.get());
+	nativeGroup->mulInPlace(result.v, r.get());
+}
+
+void AddHomElGamalEnc::customIndexedRandomizedEquality(NativeElGamalCiphertext &result, const vector<NativeElGamalCiphertext *> &indexVector,
+													   vector<biginteger> &plaintextVector, const NativeElGamalCiphertext &minusCompareElement,
+													   const NativeElGamalCiphertext &encryptedZero, biginteger &randomness)
+{
+	nativeInnerProduct(result, indexVector, plaintextVector, {make_pair(&minusCompareElement, randomness), make_pair(&encryptedZero, biginteger(1))});
+}
+
 bool AddHomElGamalEnc::decryptsToZero(AsymmetricCiphertext *cipher)
 {
+	if (nativeGroup)
+	{
+		unique_ptr<NativeElGamalCiphertext> converted;
+		auto c = toNative(cipher, converted);
+		NativeECPoint uExpX = nativeGroup->newPoint();
+		nativeGroup->mul(uExpX, c->u, getNativeX());
+		return nativeGroup->equals(uExpX, c->v);
+	}
 
 	auto c = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher);
 	// if (c == NULL)
@@ -673,12 +1403,103 @@ shared_ptr<AsymmetricCiphertext> AddHomElGamalEnc::reconstructCiphertext(const s
 	return shared_ptr<AsymmetricCiphertext>(cipherText);
 }
 
-AsymmetricCiphertext *AddHomElGamalEnc::reconstructCiphertextPointer(const string &data, bool checkMembership)
+bool AddHomElGamalEnc::checkMembershipBatch(const vector<AsymmetricCiphertext *> &ciphers)
+{
+	if (nativeGroup)
+	{
+		// Points on the curve are already checked on reconstruction, only the subgroup is left
+		vector<unique_ptr<NativeElGamalCiphertext>> converted(ciphers.size());
+		vector<const EC_POINT *> points;
+		points.reserve(2 * ciphers.size());
+		for (size_t i = 0; i < ciphers.size(); i++)
+		{
+			auto c = toNative(ciphers[i], converted[i]);
+			points.push_back(c->u.get());
+			points.push_back(c->v.get());
+		}
+		return nativeGroup->inPrimeOrderSubgroup(points);
+	}
+
+	if (validationGroup)
+	{
+		// Setting the affine coordinates checks the curve equation, the subgroup is checked as on the native backend
+		vector<NativeECPoint> converted(2 * ciphers.size());
+		vector<const EC_POINT *> points;
+		points.reserve(converted.size());
+		for (size_t i = 0; i < ciphers.size(); i++)
+		{
+			auto c = dynamic_cast<ElGamalOnGroupElementCiphertext *>(ciphers[i]);
+			auto u = c == NULL ? NULL : dynamic_cast<ECElement *>(c->getC1().get());
+			auto v = c == NULL ? NULL : dynamic_cast<ECElement *>(c->getC2().get());
+			if (u == NULL || v == NULL)
+			{
+				return false;
+			}
+			try
+			{
+				validationGroup->setAffine(converted[2 * i], u->getX(), u->getY(), false);
+				validationGroup->setAffine(converted[2 * i + 1], v->getX(), v->getY(), false);
+			}
+			catch (invalid_argument &)
+			{
+				return false;
+			}
+			points.push_back(converted[2 * i].get());
+			points.push_back(converted[2 * i + 1].get());
+		}
+		return validationGroup->inPrimeOrderSubgroup(points);
+	}
+
+	for (auto cipher : ciphers)
+	{
+		auto c = dynamic_cast<ElGamalOnGroupElementCiphertext *>(cipher);
+		if (c == NULL || !dlog->isMember(c->getC1().get()) || !dlog->isMember(c->getC2().get()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+AsymmetricCiphertext *AddHomElGamalEnc::reconstructCiphertextPointer(const string &data, bool checkMembership, CiphertextArena *arena)
 {
 	auto str_vec = explode(data, ':');
-	if (str_vec.size() == 2)
+	bool ristretto = nativeGroup && nativeGroup->isRistretto();
+	if (ristretto && str_vec.size() != 2)
+	{
+		throw invalid_argument("Error, ristretto255 ciphertexts are encoded as u:v");
+	}
+	if (!ristretto && str_vec.size() != 4)
 	{
-		throw new NotImplementedException("Error reconstruct this type of ciphertext not implemented");
+		throw invalid_argument("Error, ciphertexts are encoded as u.x:u.y:v.x:v.y");
+	}
+
+	if (nativeGroup)
+	{
+		// Arena ciphertexts are simply overwritten, their points are already allocated
+		auto cipher = newNativeCiphertext(arena);
+		try
+		{
+			if (ristretto)
+			{
+				nativeGroup->decode(cipher->u, str_vec[0], checkMembership);
+				nativeGroup->decode(cipher->v, str_vec[1], checkMembership);
+			}
+			else
+			{
+				nativeGroup->setAffine(cipher->u, str_vec[0], str_vec[1], checkMembership);
+				nativeGroup->setAffine(cipher->v, str_vec[2], str_vec[3], checkMembership);
+			}
+		}
+		catch (...)
+		{
+			if (arena == nullptr)
+			{
+				delete cipher;
+			}
+			throw;
+		}
+		return cipher;
 	}
 
 	biginteger u1 = biginteger(str_vec[0]);
@@ -691,12 +1512,11 @@ AsymmetricCiphertext *AddHomElGamalEnc::reconstructCiphertextPointer(const strin
 
 	shared_ptr<GroupElement> c1 = dlog->generateElement(checkMembership, u);
 	shared_ptr<GroupElement> c2 = dlog->generateElement(checkMembership, v);
-	return new ElGamalOnGroupElementCiphertext(c1, c2);
+	return track(new ElGamalOnGroupElementCiphertext(c1, c2), arena);
 }
 
-AsymmetricCiphertext *AddHomElGamalEnc::reconstructCiphertextPointer(const vector<unsigned char> &byteVector, bool checkMembership)
+AsymmetricCiphertext *AddHomElGamalEnc::reconstructCiphertextPointer(const vector<unsigned char> &byteVector, bool checkMembership, CiphertextArena *arena)
 {
-	const byte *uc = &(byteVector[0]);
-	std::string s(reinterpret_cast<char const *>(uc), byteVector.size());
-	return reconstructCiphertextPointer(s, checkMembership);
+	std::string s(reinterpret_cast<char const *>(byteVector.data()), byteVector.size());
+	return reconstructCiphertextPointer(s, checkMembership, arena);
 }
\ No newline at end of file
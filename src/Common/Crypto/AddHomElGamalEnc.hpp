@@ -14,6 +14,18 @@
 #include "primitives/DlogOpenSSL.hpp"
 #include "primitives/Kdf.hpp"
 #include "primitives/PrfOpenSSL.hpp"
+#include "CiphertextArena.hpp"
+#include "GeneratorPowerCache.hpp"
+#include "EncryptedZeroPool.hpp"
+
+/**
+ * @brief Window tables of the u and v points of an index vector, see AddHomElGamalEnc::buildIndexTables.
+ */
+struct NativeIndexTables
+{
+	vector<NativeECWindowTable> uTables;
+	vector<NativeECWindowTable> vTables;
+};
 
 /**
  * @brief Class that implements the additive homomorphic 'lifted' ElGamal sheme with various performance improvements and features.
@@ -36,6 +48,38 @@ protected:
 
 	shared_ptr<AsymmetricCiphertext> completeEncryption(const shared_ptr<GroupElement> &c1, GroupElement *hy, Plaintext *plaintext) override;
 
+private:
+	// Native backend (OpenSSL EC_POINTs), only set if enabled via enableNativeBackend
+	shared_ptr<NativeECGroup> nativeGroup;
+	shared_ptr<NativeECPoint> nativeH;
+	ElGamalPublicKey *nativeHSource = nullptr;
+	shared_ptr<BIGNUM> nativeX;
+	ElGamalPrivateKey *nativeXSource = nullptr;
+	shared_ptr<const GeneratorPowerCache> generatorPowers; // optional, g^item of the server items
+	shared_ptr<EncryptedZeroPool> encryptedZeroPool;	   // optional, re-randomization zeros under the public key
+	shared_ptr<NativeECGroup> validationGroup;			   // optional, batch membership checks of the libscapi backend
+
+	const NativeECPoint &getNativeH();
+	const BIGNUM *getNativeX();
+	void toNativePoint(NativeECPoint &nativePoint, GroupElement *element);
+	shared_ptr<GroupElement> toScapiElement(const NativeECPoint &nativePoint);
+	NativeElGamalCiphertext *newNativeCiphertext(CiphertextArena *arena);
+	AsymmetricCiphertext *track(AsymmetricCiphertext *cipher, CiphertextArena *arena);
+	void nativeGeneratorPower(NativeECPoint &result, biginteger &exponent);
+	shared_ptr<GroupElement> generatorPower(biginteger &exponent);
+	biginteger randomExponent();
+	// Scratch state of the typed inner products, reused across calls
+	vector<const EC_POINT *> scratchUPoints;
+	vector<const EC_POINT *> scratchVPoints;
+	vector<const BIGNUM *> scratchScalars;
+	vector<const NativeECWindowTable *> scratchUTables;
+	vector<const NativeECWindowTable *> scratchVTables;
+
+	void nativeInnerProduct(NativeElGamalCiphertext &result, const vector<NativeElGamalCiphertext *> &indexVector, vector<biginteger> &plaintextVector,
+							const vector<pair<const NativeElGamalCiphertext *, biginteger>> &additionalTerms);
+	shared_ptr<AsymmetricCiphertext> nativeInnerProduct(vector<AsymmetricCiphertext *> &indexVector, vector<biginteger> &plaintextVector,
+														const vector<pair<AsymmetricCiphertext *, biginteger>> &additionalTerms);
+
 public:
 	AddHomElGamalEnc() {}
 
@@ -50,6 +94,82 @@ public:
 	 */
 	AddHomElGamalEnc(const shared_ptr<DlogGroup> &dlogGroup, const shared_ptr<PrgFromOpenSSLAES> &random = get_seeded_prg()) : ElGamalEnc(dlogGroup, random) {}
 
+	/**
+	 * @brief Switches all homomorphic operations, encryption, decryption and ciphertext reconstruction
+	 * 		  to the native OpenSSL backend. The libscapi dlog group stays in use for key generation and key exchange.
+	 * 		  Ciphertexts of the libscapi backend are still accepted as input and converted on the fly.
+	 *
+	 * 		  RISTRETTO255_CURVE_NAME has no libscapi group: construct the object without dlog group,
+	 * 		  enable the native backend and use the native keys (generateNativeKey, setNativePublicKey) instead.
+	 *
+	 * @param curveName NIST name of the curve, has to match the curve of the libscapi dlog group
+	 */
+	void enableNativeBackend(const string &curveName);
+
+	/**
+	 * @brief Generates a key pair in the native group and uses it instead of the libscapi keys.
+	 */
+	void generateNativeKey();
+
+	/**
+	 * @brief Returns the public key h in the wire format of the native group (NativeECGroup::encode).
+	 */
+	string getEncodedNativePublicKey();
+
+	/**
+	 * @brief Sets the public key received from getEncodedNativePublicKey, throws invalid_argument for invalid keys.
+	 */
+	void setNativePublicKey(const string &encoded);
+
+	bool usesNativeBackend() { return nativeGroup != nullptr; }
+
+	/**
+	 * @brief Lets checkMembershipBatch of the libscapi backend check in a native group instead of per element with
+	 * 		  isMember (n * P on binary curves). Nothing else changes, the native backend does not need it.
+	 *
+	 * @param curveName NIST name of the curve, has to match the curve of the libscapi dlog group
+	 */
+	void enableNativeValidation(const string &curveName);
+
+	shared_ptr<NativeECGroup> getNativeGroup() { return nativeGroup; }
+
+	/**
+	 * @brief Copy with the same keys, caches and pool but its own native group, i.e., its own scratch state.
+	 * 		  Forks of one cryptor can run the typed native operations concurrently. Requires the native backend.
+	 */
+	AddHomElGamalEnc forkNative();
+
+	/**
+	 * @brief Looks up g^m in cache instead of computing it in elementXorByConstPointer and randomizedEquality with plaintext,
+	 * 		  exponents missing in the cache are still computed. The cache is read-only and can be shared between threads.
+	 */
+	void setGeneratorPowerCache(const shared_ptr<const GeneratorPowerCache> &cache) { generatorPowers = cache; }
+
+	/**
+	 * @brief Creates a pool of encryptions of zero under the current public key, see EncryptedZeroPool. Requires the native backend.
+	 */
+	shared_ptr<EncryptedZeroPool> newEncryptedZeroPool(size_t capacity);
+
+	/**
+	 * @brief Lets the PIEs draw fresh re-randomization zeros from pool on every run instead of encrypting them on construction.
+	 * 		  The pool has to belong to the public key of this cryptor and is only used by the native backend.
+	 */
+	void setEncryptedZeroPool(const shared_ptr<EncryptedZeroPool> &pool) { encryptedZeroPool = pool; }
+
+	bool usesEncryptedZeroPool() { return nativeGroup != nullptr && encryptedZeroPool != nullptr; }
+
+	/**
+	 * @brief Overwrites all targets with fresh encryptions of zero from the pool, see EncryptedZeroPool::take.
+	 */
+	void drawEncryptedZeros(const vector<NativeElGamalCiphertext *> &targets);
+
+	using ElGamalEnc::encrypt;
+
+	/**
+	 * @brief Encrypts a BigIntegerPlainText m as (g^r, h^r * g^m), natively if the native backend is enabled.
+	 */
+	shared_ptr<AsymmetricCiphertext> encrypt(const shared_ptr<Plaintext> &plaintext);
+
 	shared_ptr<AsymmetricCiphertext> encryptWithSecretKey(biginteger &plaintext);
 
 	/**
@@ -102,7 +222,10 @@ public:
 	 */
 	shared_ptr<AsymmetricCiphertext> add(AsymmetricCiphertext *cipher1, AsymmetricCiphertext *cipher2);
 
-	AsymmetricCiphertext *addPointer(AsymmetricCiphertext *cipher1, AsymmetricCiphertext *cipher2);
+	/**
+	 * @brief Raw pointer variant of add. The result is owned by arena if given, otherwise by the caller.
+	 */
+	AsymmetricCiphertext *addPointer(AsymmetricCiphertext *cipher1, AsymmetricCiphertext *cipher2, CiphertextArena *arena = nullptr);
 
 	/**
 	 * Calculates the ciphertext resulting of adding two given ciphertexts.
@@ -122,6 +245,40 @@ public:
 
 	shared_ptr<AsymmetricCiphertext> subtract(AsymmetricCiphertext *cipher1, AsymmetricCiphertext *cipher2);
 
+	/**
+	 * @brief In-place variants of add, subtract and multByConst, the accumulator is overwritten with the result.
+	 * 		  Native accumulators are not normalized, call normalize once after the last operation.
+	 */
+	void addInPlace(AsymmetricCiphertext *accumulator, AsymmetricCiphertext *cipher);
+
+	void subInPlace(AsymmetricCiphertext *accumulator, AsymmetricCiphertext *cipher);
+
+	void multByConstInPlace(AsymmetricCiphertext *accumulator, biginteger &constNumber);
+
+	/**
+	 * @brief Converts a native ciphertext to affine coordinates, no-op for libscapi ciphertexts.
+	 */
+	void normalize(AsymmetricCiphertext *cipher);
+
+	/**
+	 * @brief Converts all native ciphertexts to affine coordinates with a single field inversion (simultaneous inversion).
+	 * 		  Should be called before encoding many ciphertexts, otherwise every encoding pays for its own inversion.
+	 */
+	void normalizeBatch(const vector<AsymmetricCiphertext *> &ciphers);
+
+	void normalizeBatch(const vector<shared_ptr<AsymmetricCiphertext>> &ciphers);
+
+	/**
+	 * @brief Wire format of a ciphertext, same as generateSendableData()->toString(). Native ciphertexts are encoded with
+	 * 		  the group of this cryptor instead of the one that created them, i.e., a worker may encode ciphertexts of other workers.
+	 */
+	string encodeCiphertext(AsymmetricCiphertext *cipher);
+
+	/**
+	 * @brief Copies a ciphertext, e.g., to initialize an accumulator. The copy is owned by arena if given, otherwise by the caller.
+	 */
+	AsymmetricCiphertext *copyPointer(AsymmetricCiphertext *cipher, CiphertextArena *arena = nullptr);
+
 	/**
 	 * Receives a cipher and a constant number and returns their multiplication.
 	 * @return the multiplication result.
@@ -146,9 +303,9 @@ public:
 	 */
 	shared_ptr<AsymmetricCiphertext> multByConst(AsymmetricCiphertext *cipher, biginteger &constNumber, biginteger &r);
 
-	AsymmetricCiphertext *multByConstPointer(AsymmetricCiphertext *cipher, biginteger &constNumber);
+	AsymmetricCiphertext *multByConstPointer(AsymmetricCiphertext *cipher, biginteger &constNumber, CiphertextArena *arena = nullptr);
 
-	AsymmetricCiphertext *elementXorByConstPointer(AsymmetricCiphertext *cipher, biginteger &elem);
+	AsymmetricCiphertext *elementXorByConstPointer(AsymmetricCiphertext *cipher, biginteger &elem, CiphertextArena *arena = nullptr);
 
 	shared_ptr<AsymmetricCiphertext> xorByConst(AsymmetricCiphertext *cipher, bool constNumber);
 
@@ -161,11 +318,79 @@ public:
 	shared_ptr<AsymmetricCiphertext> indexedRandomizedEquality(vector<AsymmetricCiphertext *> &indexVector, vector<biginteger> &plaintextVector,
 															   AsymmetricCiphertext *minusCompareElement, AsymmetricCiphertext *encryptedZero);
 
+	/**
+	 * @brief Precomputes window tables for all ciphertexts of indexVector, so that many plaintext vectors with at most scalarBits bits
+	 * 		  can be evaluated against the same index vector with tabledIndexedRandomizedEquality. Only supported by the native backend.
+	 *
+	 * @return false if the native backend is not enabled, tables stay untouched then
+	 */
+	bool buildIndexTables(NativeIndexTables &tables, vector<AsymmetricCiphertext *> &indexVector, int scalarBits, unsigned int windowSize);
+
+	/**
+	 * @brief Recodes a plaintext vector with at most scalarBits bits per entry for tabledIndexedRandomizedEquality,
+	 * 		  e.g., the server items in the offline phase. Only supported by the native backend.
+	 *
+	 * @return false if the native backend is not enabled, recoded stays untouched then
+	 */
+	bool recodePlaintexts(NativeRecodedScalars &recoded, vector<biginteger> &plaintextVector, int scalarBits, unsigned int windowSize);
+
+	/**
+	 * @brief Same result as indexedRandomizedEquality, but the inner product uses the precomputed tables of the index vector.
+	 */
+	shared_ptr<AsymmetricCiphertext> tabledIndexedRandomizedEquality(const NativeIndexTables &tables, vector<biginteger> &plaintextVector,
+																	 AsymmetricCiphertext *minusCompareElement, AsymmetricCiphertext *encryptedZero);
+
+	/**
+	 * @brief Like above, with a plaintext vector recoded by recodePlaintexts with the window size of the tables.
+	 */
+	shared_ptr<AsymmetricCiphertext> tabledIndexedRandomizedEquality(const NativeIndexTables &tables, const NativeRecodedScalars &recodedPlaintexts,
+																	 AsymmetricCiphertext *minusCompareElement, AsymmetricCiphertext *encryptedZero);
+
 	shared_ptr<AsymmetricCiphertext> customIndexedRandomizedEquality(vector<AsymmetricCiphertext *> &indexVector, vector<biginteger> &plaintextVector,
 																	 AsymmetricCiphertext *minusCompareElement, AsymmetricCiphertext *encryptedZero, biginteger &randomness);
 
 	bool decryptsToZero(AsymmetricCiphertext *cipher);
 
+	/**
+	 * @brief Returns cipher as native ciphertext, libscapi ciphertexts are converted into converted, which owns the result.
+	 * 		  Meant to resolve the inputs of a hot loop once for the typed operations below. Requires the native backend.
+	 */
+	NativeElGamalCiphertext *toNative(AsymmetricCiphertext *cipher, unique_ptr<NativeElGamalCiphertext> &converted);
+
+	/**
+	 * @brief Typed operations of the native backend for the hot loops of the PIEs: no RTTI, no virtual calls and no shared_ptr.
+	 * 		  Results are written into caller owned ciphertexts (e.g., from an arena), which must not alias the inputs
+	 * 		  unless stated otherwise. Same semantics as the generic operations of the same name, require the native backend.
+	 */
+	void copy(NativeElGamalCiphertext &result, const NativeElGamalCiphertext &cipher);
+
+	/**
+	 * @brief accumulator += cipher, the accumulator is not normalized.
+	 */
+	void addInPlace(NativeElGamalCiphertext &accumulator, const NativeElGamalCiphertext &cipher);
+
+	void multByConst(NativeElGamalCiphertext &result, const NativeElGamalCiphertext &cipher, biginteger &constNumber);
+
+	void elementXorByConst(NativeElGamalCiphertext &result, const NativeElGamalCiphertext &cipher, biginteger &elem);
+
+	void normalize(NativeElGamalCiphertext &cipher);
+
+	void randomizedEquality(NativeElGamalCiphertext &result, const NativeElGamalCiphertext &minusCompareElement,
+							const NativeElGamalCiphertext &secondCompareElement, const NativeElGamalCiphertext &encryptedZero);
+
+	void randomizedEquality(NativeElGamalCiphertext &result, const NativeElGamalCiphertext &minusCompareElement, biginteger &plaintext);
+
+	void indexedRandomizedEquality(NativeElGamalCiphertext &result, const vector<NativeElGamalCiphertext *> &indexVector, vector<biginteger> &plaintextVector,
+								   const NativeElGamalCiphertext &minusCompareElement, const NativeElGamalCiphertext &encryptedZero);
+
+	bool buildIndexTables(NativeIndexTables &tables, const vector<NativeElGamalCiphertext *> &indexVector, int scalarBits, unsigned int windowSize);
+
+	void tabledIndexedRandomizedEquality(NativeElGamalCiphertext &result, const NativeIndexTables &tables, const NativeRecodedScalars &recodedPlaintexts,
+										 const NativeElGamalCiphertext &minusCompareElement, const NativeElGamalCiphertext &encryptedZero);
+
+	void customIndexedRandomizedEquality(NativeElGamalCiphertext &result, const vector<NativeElGamalCiphertext *> &indexVector, vector<biginteger> &plaintextVector,
+										 const NativeElGamalCiphertext &minusCompareElement, const NativeElGamalCiphertext &encryptedZero, biginteger &randomness);
+
 	/**
 	 * @see edu.biu.scapi.midLayer.asymmetricCrypto.encryption.AsymmetricEnc#reconstructCiphertext(edu.biu.scapi.midLayer.ciphertext.AsymmetricCiphertextSendableData)
 	 */
@@ -175,7 +400,17 @@ public:
 
 	shared_ptr<AsymmetricCiphertext> reconstructCiphertext(const string &data, bool checkMembership = true);
 
-	AsymmetricCiphertext *reconstructCiphertextPointer(const string &data, bool checkMembership = true);
+	/**
+	 * @brief Checks that both points of all ciphertexts are members of the group, meant for ciphertexts
+	 * 		  reconstructed without membership check. The native backend checks the whole batch at once, so does the
+	 * 		  libscapi backend with enableNativeValidation.
+	 */
+	bool checkMembershipBatch(const vector<AsymmetricCiphertext *> &ciphers);
+
+	/**
+	 * @brief Decodes a "ux:uy:vx:vy" ciphertext ("u:v" for ristretto255). The result is owned by arena if given, otherwise by the caller.
+	 */
+	AsymmetricCiphertext *reconstructCiphertextPointer(const string &data, bool checkMembership = true, CiphertextArena *arena = nullptr);
 
-	AsymmetricCiphertext *reconstructCiphertextPointer(const vector<unsigned char> &data, bool checkMembership = true);
+	AsymmetricCiphertext *reconstructCiphertextPointer(const vector<unsigned char> &data, bool checkMembership = true, CiphertextArena *arena = nullptr);
 };
@@ -0,0 +1,82 @@
+/**
+ * @file CiphertextArena.hpp
+ *
+ * @version 0.1
+ *
+ */
+#pragma once
+#include <deque>
+#include "NativeElGamalCiphertext.hpp"
+
+/**
+ * @brief Per-session owner of the raw ciphertexts created on the ElGamal PIE path.
+ *
+ * Native ciphertexts are handed out from chunked storage and reused after reset(), so their EC_POINTs
+ * are allocated once and then overwritten in place. libscapi ciphertexts cannot be reused and are adopted instead,
+ * i.e., the arena frees them in bulk on reset().
+ *
+ * @warning Not thread-safe, use one arena per thread (e.g., one per PIE collection).
+ */
+class CiphertextArena
+{
+private:
+    std::deque<NativeElGamalCiphertext> nativeCiphertexts; // deque keeps addresses stable on growth
+    size_t nativeInUse = 0;
+    std::vector<std::unique_ptr<AsymmetricCiphertext>> adoptedCiphertexts;
+
+public:
+    CiphertextArena() {}
+
+    CiphertextArena(const CiphertextArena &) = delete;
+    CiphertextArena &operator=(const CiphertextArena &) = delete;
+
+    /**
+     * @brief Returns a native ciphertext owned by the arena. Its points hold arbitrary values of a previous session.
+     */
+    NativeElGamalCiphertext *acquireNative(NativeECGroup &group)
+    {
+        if (nativeInUse == nativeCiphertexts.size())
+        {
+            nativeCiphertexts.emplace_back(group);
+        }
+        NativeElGamalCiphertext *cipher = &nativeCiphertexts[nativeInUse++];
+        if (cipher->group != &group)
+        {
+            cipher->group = &group;
+            cipher->u = group.newPoint();
+            cipher->v = group.newPoint();
+        }
+        return cipher;
+    }
+
+    /**
+     * @brief Takes ownership of a heap allocated ciphertext, which is deleted on the next reset().
+     */
+    AsymmetricCiphertext *adopt(AsymmetricCiphertext *cipher)
+    {
+        adoptedCiphertexts.emplace_back(cipher);
+        return cipher;
+    }
+
+    /**
+     * @brief Ends the session: all handed out ciphertexts become invalid, native storage is kept for reuse.
+     */
+    void reset()
+    {
+        nativeInUse = 0;
+        adoptedCiphertexts.clear();
+    }
+
+    /**
+     * @brief Like reset(), but also frees the native storage.
+     */
+    void release()
+    {
+        reset();
+        nativeCiphertexts.clear();
+    }
+
+    size_t getNativeInUse() const { return nativeInUse; }
+    size_t getNativeCapacity() const { return nativeCiphertexts.size(); }
+    size_t getAdoptedCount() const { return adoptedCiphertexts.size(); }
+};
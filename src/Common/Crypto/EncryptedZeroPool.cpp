@@ -0,0 +1,166 @@
+/**
+ * @file EncryptedZeroPool.cpp
+ *
+ * @version 0.1
+ *
+ */
+#include "EncryptedZeroPool.hpp"
+#include <algorithm>
+#include <iterator>
+
+EncryptedZeroPool::EncryptedZeroPool(const std::string &curveName, const NativeECPoint &h, size_t capacity)
+    : curveName(curveName), capacity(capacity)
+{
+    NativeECGroup group(curveName);
+    scalarBits = BN_num_bits(group.getOrder());
+    unsigned int windowSize = NativeECGroup::tableWindowSize(capacity, scalarBits, ENCRYPTED_ZERO_POOL_MAX_WINDOW_SIZE);
+    group.buildWindowTable(gTable, group.getGenerator(), scalarBits, windowSize);
+    group.buildWindowTable(hTable, h, scalarBits, windowSize);
+}
+
+EncryptedZeroPool::~EncryptedZeroPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    refillNeeded.notify_all();
+    if (refillThread.joinable())
+    {
+        refillThread.join();
+    }
+}
+
+/**
+ * @brief u_i = g^r_i, v_i = h^r_i for fresh random r_i, all points normalized at once.
+ */
+void EncryptedZeroPool::generate(NativeECGroup &group, const std::vector<NativeECPoint *> &u, const std::vector<NativeECPoint *> &v)
+{
+    std::vector<const NativeECWindowTable *> uTables{&gTable};
+    std::vector<const NativeECWindowTable *> vTables{&hTable};
+    NativeRecodedScalars recoded;
+    std::vector<EC_POINT *> toNormalize;
+    toNormalize.reserve(2 * u.size());
+    for (size_t i = 0; i < u.size(); i++)
+    {
+        auto r = group.randomScalar();
+        NativeECGroup::recodeScalars(recoded, {r.get()}, scalarBits, gTable.windowSize);
+        group.multiMulPairWithTables(*u[i], *v[i], uTables, vTables, recoded);
+        toNormalize.push_back(u[i]->get());
+        toNormalize.push_back(v[i]->get());
+    }
+    group.normalize(toNormalize);
+}
+
+void EncryptedZeroPool::produceChunk(NativeECGroup &group, size_t count)
+{
+    std::vector<NativeECPoint> u, v;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!sparePoints.empty() && v.size() < count)
+        {
+            (u.size() < count ? u : v).push_back(std::move(sparePoints.back()));
+            sparePoints.pop_back();
+        }
+    }
+    while (u.size() < count)
+    {
+        u.push_back(group.newPoint());
+    }
+    while (v.size() < count)
+    {
+        v.push_back(group.newPoint());
+    }
+
+    std::vector<NativeECPoint *> uTargets(count), vTargets(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        uTargets[i] = &u[i];
+        vTargets[i] = &v[i];
+    }
+    generate(group, uTargets, vTargets);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::move(u.begin(), u.end(), std::back_inserter(uPoints));
+    std::move(v.begin(), v.end(), std::back_inserter(vPoints));
+}
+
+void EncryptedZeroPool::fill()
+{
+    size_t missing = capacity - std::min(capacity, available());
+    long numberOfChunks = long((missing + ENCRYPTED_ZERO_POOL_CHUNK - 1) / ENCRYPTED_ZERO_POOL_CHUNK);
+#pragma omp parallel
+    {
+        // EC groups are not thread-safe, every thread works with its own one
+        NativeECGroup group(curveName);
+
+#pragma omp for schedule(dynamic)
+        for (long chunk = 0; chunk < numberOfChunks; chunk++)
+        {
+            size_t begin = size_t(chunk) * ENCRYPTED_ZERO_POOL_CHUNK;
+            produceChunk(group, std::min(missing, begin + ENCRYPTED_ZERO_POOL_CHUNK) - begin);
+        }
+    }
+}
+
+void EncryptedZeroPool::refillLoop()
+{
+    NativeECGroup group(curveName);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopped)
+    {
+        if (uPoints.size() >= capacity)
+        {
+            refillNeeded.wait(lock);
+            continue;
+        }
+        size_t count = std::min(size_t(ENCRYPTED_ZERO_POOL_CHUNK), capacity - uPoints.size());
+        lock.unlock();
+        produceChunk(group, count);
+        lock.lock();
+    }
+}
+
+void EncryptedZeroPool::startBackgroundRefill()
+{
+    if (!refillThread.joinable())
+    {
+        refillThread = std::thread(&EncryptedZeroPool::refillLoop, this);
+    }
+}
+
+void EncryptedZeroPool::take(NativeECGroup &group, const std::vector<NativeElGamalCiphertext *> &targets)
+{
+    size_t fromPool;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fromPool = std::min(targets.size(), uPoints.size());
+        for (size_t i = 0; i < fromPool; i++)
+        {
+            std::swap(targets[i]->u, uPoints.back());
+            std::swap(targets[i]->v, vPoints.back());
+            sparePoints.push_back(std::move(uPoints.back()));
+            sparePoints.push_back(std::move(vPoints.back()));
+            uPoints.pop_back();
+            vPoints.pop_back();
+        }
+    }
+    refillNeeded.notify_one();
+
+    if (fromPool < targets.size())
+    {
+        std::vector<NativeECPoint *> u, v;
+        for (size_t i = fromPool; i < targets.size(); i++)
+        {
+            u.push_back(&targets[i]->u);
+            v.push_back(&targets[i]->v);
+        }
+        generate(group, u, v);
+    }
+}
+
+size_t EncryptedZeroPool::available()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return uPoints.size();
+}
@@ -0,0 +1,89 @@
+/**
+ * @file EncryptedZeroPool.hpp
+ *
+ * @version 0.1
+ *
+ */
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "NativeElGamalCiphertext.hpp"
+
+// Zeros generated per chunk, i.e., per batch normalization and per insertion into the pool
+#ifndef ENCRYPTED_ZERO_POOL_CHUNK
+#define ENCRYPTED_ZERO_POOL_CHUNK 256
+#endif
+
+// Upper bound of the window size of the fixed-base tables of g and h
+#ifndef ENCRYPTED_ZERO_POOL_MAX_WINDOW_SIZE
+#define ENCRYPTED_ZERO_POOL_MAX_WINDOW_SIZE 8
+#endif
+
+/**
+ * @brief Pool of encryptions of zero (g^r, h^r) under a fixed public key h, the re-randomization zeros of the PIE results.
+ *
+ * Zeros are computed with fixed-base window tables of g and h (one addition per window and point instead of
+ * a full multiplication) and normalized per chunk with a single inversion. fill() fills the pool in parallel,
+ * the background thread of startBackgroundRefill() tops it up whenever zeros were taken.
+ * Consumers swap their points with the ones of the pool, so no EC_POINT is allocated in a session.
+ *
+ * Thread-safe, meant to be shared by all cryptors of the same public key. Points move between NativeECGroup instances,
+ * which is valid as all groups of a curve share one EC_GROUP (NativeECCurve).
+ */
+class EncryptedZeroPool
+{
+private:
+    std::string curveName;
+    size_t capacity;
+    int scalarBits;
+    NativeECWindowTable gTable; // read-only after construction
+    NativeECWindowTable hTable;
+
+    std::mutex mutex;
+    std::condition_variable refillNeeded;
+    std::vector<NativeECPoint> uPoints; // available zeros, normalized
+    std::vector<NativeECPoint> vPoints;
+    std::vector<NativeECPoint> sparePoints; // handed back by take, overwritten by the next chunk
+    bool stopped = false;
+    std::thread refillThread;
+
+    void generate(NativeECGroup &group, const std::vector<NativeECPoint *> &u, const std::vector<NativeECPoint *> &v);
+    void produceChunk(NativeECGroup &group, size_t count);
+    void refillLoop();
+
+public:
+    /**
+     * @param h public key, a point of curveName
+     * @param capacity number of zeros the pool is filled up to, e.g., the number of PIE results of one session
+     */
+    EncryptedZeroPool(const std::string &curveName, const NativeECPoint &h, size_t capacity);
+
+    /**
+     * @brief Stops and joins the background thread.
+     */
+    ~EncryptedZeroPool();
+
+    EncryptedZeroPool(const EncryptedZeroPool &) = delete;
+    EncryptedZeroPool &operator=(const EncryptedZeroPool &) = delete;
+
+    /**
+     * @brief Fills the pool up to its capacity with all OpenMP threads, returns once it is full.
+     */
+    void fill();
+
+    /**
+     * @brief Starts a thread that keeps the pool filled up to its capacity until the pool is destroyed.
+     */
+    void startBackgroundRefill();
+
+    /**
+     * @brief Overwrites u and v of all targets with fresh zeros. If the pool runs dry, the remaining zeros
+     *        are computed with group of the calling thread, so take never blocks on the background thread.
+     */
+    void take(NativeECGroup &group, const std::vector<NativeElGamalCiphertext *> &targets);
+
+    size_t available();
+
+    size_t getCapacity() const { return capacity; }
+};
@@ -0,0 +1,96 @@
+/**
+ * @file GeneratorPowerCache.cpp
+ *
+ * @version 0.1
+ *
+ */
+#include "GeneratorPowerCache.hpp"
+#include <algorithm>
+
+// Points per batch normalization while building the cache
+#define GENERATOR_POWER_CACHE_CHUNK 1024
+
+void GeneratorPowerCache::build(const std::vector<biginteger> &serverItems)
+{
+    items.clear();
+    for (auto &item : serverItems)
+    {
+        if (item != 0)
+        {
+            items.push_back(item);
+        }
+    }
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+
+    pointOctets = NativeECGroup(curveName).getPointOctets();
+    points.assign(items.size() * pointOctets, 0);
+
+    long numberOfChunks = long((items.size() + GENERATOR_POWER_CACHE_CHUNK - 1) / GENERATOR_POWER_CACHE_CHUNK);
+#pragma omp parallel
+    {
+        // EC groups are not thread-safe, every thread works with its own one
+        NativeECGroup group(curveName);
+        std::vector<NativeECPoint> chunkPoints;
+        for (size_t i = 0; i < GENERATOR_POWER_CACHE_CHUNK; i++)
+        {
+            chunkPoints.push_back(group.newPoint());
+        }
+
+#pragma omp for schedule(dynamic)
+        for (long chunk = 0; chunk < numberOfChunks; chunk++)
+        {
+            size_t begin = size_t(chunk) * GENERATOR_POWER_CACHE_CHUNK;
+            size_t end = std::min(items.size(), begin + GENERATOR_POWER_CACHE_CHUNK);
+            std::vector<EC_POINT *> toNormalize;
+            for (size_t i = begin; i < end; i++)
+            {
+                auto scalar = group.toScalar(items[i]);
+                group.mulGenerator(chunkPoints[i - begin], scalar.get());
+                toNormalize.push_back(chunkPoints[i - begin].get());
+            }
+            group.normalize(toNormalize);
+            for (size_t i = begin; i < end; i++)
+            {
+                group.toOctets(chunkPoints[i - begin], &points[i * pointOctets]);
+            }
+        }
+    }
+}
+
+const unsigned char *GeneratorPowerCache::find(const biginteger &item) const
+{
+    auto position = std::lower_bound(items.begin(), items.end(), item);
+    if (position == items.end() || *position != item)
+    {
+        return nullptr;
+    }
+    return &points[size_t(position - items.begin()) * pointOctets];
+}
+
+bool GeneratorPowerCache::lookUp(NativeECGroup &group, NativeECPoint &result, const biginteger &item) const
+{
+    const unsigned char *encoded = find(item);
+    if (encoded == nullptr)
+    {
+        return false;
+    }
+    group.fromOctets(result, encoded);
+    return true;
+}
+
+bool GeneratorPowerCache::lookUpAffine(const biginteger &item, biginteger &x, biginteger &y) const
+{
+    const unsigned char *encoded = find(item);
+    if (encoded == nullptr)
+    {
+        return false;
+    }
+    // Skip the 04 prefix, x and y follow with half of the remaining bytes each
+    int coordinateOctets = int(pointOctets / 2);
+    BigNumPtr bnX(BN_bin2bn(encoded + 1, coordinateOctets, nullptr));
+    BigNumPtr bnY(BN_bin2bn(encoded + 1 + coordinateOctets, coordinateOctets, nullptr));
+    x = bnToBiginteger(bnX.get());
+    y = bnToBiginteger(bnY.get());
+    return true;
+}
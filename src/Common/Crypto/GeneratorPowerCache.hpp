@@ -0,0 +1,52 @@
+/**
+ * @file GeneratorPowerCache.hpp
+ *
+ * @version 0.1
+ *
+ */
+#pragma once
+#include "NativeECGroup.hpp"
+
+/**
+ * @brief Read-only cache of g^item for all items of the server set.
+ *
+ * Built once during the offline phase and shared by all PIE collections, i.e., by all threads.
+ * Points are stored in their uncompressed binary encoding in one contiguous buffer (65 bytes per item for P-256)
+ * instead of EC_POINT objects, the items themselves are kept sorted for the look up.
+ * The dummy element 0 is not cached.
+ */
+class GeneratorPowerCache
+{
+private:
+    std::string curveName;
+    size_t pointOctets = 0;
+    std::vector<biginteger> items;     // sorted and unique
+    std::vector<unsigned char> points; // pointOctets per item, same order as items
+
+    const unsigned char *find(const biginteger &item) const;
+
+public:
+    explicit GeneratorPowerCache(const std::string &curveName) : curveName(curveName) {}
+
+    /**
+     * @brief Computes g^item for all non-zero items, in parallel with the OpenMP threads. Replaces the current content.
+     */
+    void build(const std::vector<biginteger> &serverItems);
+
+    /**
+     * @brief Sets result to g^item if item is cached.
+     *
+     * @param group native group of the calling thread, has to be the curve of the cache
+     * @return false if item is not cached, result stays untouched then
+     */
+    bool lookUp(NativeECGroup &group, NativeECPoint &result, const biginteger &item) const;
+
+    /**
+     * @brief Returns the affine coordinates of g^item if item is cached, used by the libscapi backend.
+     */
+    bool lookUpAffine(const biginteger &item, biginteger &x, biginteger &y) const;
+
+    size_t size() const { return items.size(); }
+
+    const std::string &getCurveName() const { return curveName; }
+};
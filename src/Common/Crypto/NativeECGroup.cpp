@@ -0,0 +1,1185 @@
+/**
+ * @file NativeECGroup.cpp
+ *
+ * @version 0.1
+ *
+ */
+#include "NativeECGroup.hpp"
+
+BigNumPtr bigintegerToBN(const biginteger &value)
+{
+    BIGNUM *bn = nullptr;
+    if (BN_dec2bn(&bn, value.str().c_str()) == 0)
+    {
+        throw runtime_error("Error, could not convert biginteger to BIGNUM");
+    }
+    return BigNumPtr(bn);
+}
+
+biginteger bnToBiginteger(const BIGNUM *bn)
+{
+    char *dec = BN_bn2dec(bn);
+    biginteger value(dec);
+    OPENSSL_free(dec);
+    return value;
+}
+
+/*
+ * OpenSSL 3.0 deprecates the EC_METHOD and the batch EC functions below without a replacement: the method is the only way to
+ * tell the generic from the specialized (nistz256, nistp*) arithmetic, and EC_POINTs_make_affine/EC_POINTs_mul are the only
+ * batch inversion and multi-exponentiation of the EC API. They are kept in these wrappers, the deprecation warnings are
+ * suppressed here only, and builds without the deprecated API (OPENSSL_NO_DEPRECATED_3_0) fall back to single point calls.
+ */
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+/**
+ * @brief true if OpenSSL multiplies on group with the generic arithmetic, i.e., the Pippenger multiplication pays off.
+ */
+static bool usesGenericArithmetic(const EC_GROUP *group)
+{
+#ifndef OPENSSL_NO_DEPRECATED_3_0
+    const EC_METHOD *method = EC_GROUP_method_of(group);
+    bool genericArithmetic = method == EC_GFp_mont_method() || method == EC_GFp_simple_method();
+#ifndef OPENSSL_NO_EC2M
+    genericArithmetic = genericArithmetic || method == EC_GF2m_simple_method();
+#endif
+    return genericArithmetic;
+#else
+    return true;
+#endif
+}
+
+static void precomputeGeneratorMultiples(EC_GROUP *group, BN_CTX *ctx)
+{
+#ifndef OPENSSL_NO_DEPRECATED_3_0
+    EC_GROUP_precompute_mult(group, ctx);
+#endif
+}
+
+static void makeAffine(const EC_GROUP *group, std::vector<EC_POINT *> &points, BN_CTX *ctx)
+{
+#ifndef OPENSSL_NO_DEPRECATED_3_0
+    EC_POINTs_make_affine(group, points.size(), points.data(), ctx);
+#else
+    // Encodings only read the affine coordinates, so skipping the batch inversion keeps the points valid
+#endif
+}
+
+static void pointsMul(const EC_GROUP *group, EC_POINT *r, const std::vector<const EC_POINT *> &points,
+                      const std::vector<const BIGNUM *> &scalars, BN_CTX *ctx)
+{
+#ifndef OPENSSL_NO_DEPRECATED_3_0
+    EC_POINTs_mul(group, r, nullptr, points.size(), const_cast<const EC_POINT **>(points.data()),
+                  const_cast<const BIGNUM **>(scalars.data()), ctx);
+#else
+    EC_POINT *term = EC_POINT_new(group);
+    EC_POINT_set_to_infinity(group, r);
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        EC_POINT_mul(group, term, nullptr, points[i], scalars[i], ctx);
+        EC_POINT_add(group, r, r, term, ctx);
+    }
+    EC_POINT_free(term);
+#endif
+}
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+/**
+ * @brief a = |a|, i.e., the even one of a and p - a (the non-negative field element of the ristretto255 encoding).
+ */
+static void fieldAbs(BIGNUM *a, const BIGNUM *p)
+{
+    if (BN_is_odd(a))
+    {
+        BN_sub(a, p, a);
+    }
+}
+
+/**
+ * @brief Tr(element) of a binary field, i.e., the parity of the coefficients selected by the trace mask (Tr is linear).
+ */
+static int fieldTrace(const std::vector<unsigned char> &traceMask, const BIGNUM *element)
+{
+    std::vector<unsigned char> bytes(traceMask.size());
+    BN_bn2binpad(element, bytes.data(), int(bytes.size()));
+    unsigned char parity = 0;
+    for (size_t i = 0; i < bytes.size(); i++)
+    {
+        parity ^= bytes[i] & traceMask[i];
+    }
+    parity ^= parity >> 4;
+    parity ^= parity >> 2;
+    parity ^= parity >> 1;
+    return parity & 1;
+}
+
+NativeECCurve::NativeECCurve(const std::string &curveName) : curveName(curveName)
+{
+    BN_CTX *ctx = BN_CTX_new();
+    if (ctx == nullptr)
+    {
+        throw runtime_error("Error, could not create native curve: " + curveName);
+    }
+    if (curveName == RISTRETTO255_CURVE_NAME)
+    {
+        group = newRistrettoGroup(ctx);
+    }
+    else
+    {
+        int nid = EC_curve_nist2nid(curveName.c_str());
+        if (nid == NID_undef)
+        {
+            BN_CTX_free(ctx);
+            throw invalid_argument("Cannot find native curve: " + curveName);
+        }
+        group = EC_GROUP_new_by_curve_name(nid);
+    }
+    if (group == nullptr)
+    {
+        BN_CTX_free(ctx);
+        throw runtime_error("Error, could not create native curve: " + curveName);
+    }
+
+    order = BigNumPtr(BN_dup(EC_GROUP_get0_order(group)));
+    generator = NativeECPoint(EC_POINT_dup(EC_GROUP_get0_generator(group), group));
+
+    pippengerThreshold = usesGenericArithmetic(group) ? PIPPENGER_THRESHOLD : SIZE_MAX;
+
+    // Precomputed multiples of g speed up encryption and g^m, shared by all threads
+    precomputeGeneratorMultiples(group, ctx);
+
+    initTraceSubgroupCheck(ctx);
+    BN_CTX_free(ctx);
+}
+
+NativeECCurve::~NativeECCurve()
+{
+    // The generator has to be released before the group
+    generator = NativeECPoint();
+    EC_GROUP_free(group);
+}
+
+std::shared_ptr<const NativeECCurve> NativeECCurve::get(const std::string &curveName)
+{
+    static std::mutex curvesMutex;
+    static std::map<std::string, std::shared_ptr<const NativeECCurve>> curves;
+
+    // Curves are created under the lock, concurrent first users of a curve wait instead of building it twice
+    std::lock_guard<std::mutex> lock(curvesMutex);
+    auto &curve = curves[curveName];
+    if (curve == nullptr)
+    {
+        curve = std::make_shared<NativeECCurve>(curveName);
+    }
+    return curve;
+}
+
+NativeECGroup::NativeECGroup(const std::string &curveName) : curve(NativeECCurve::get(curveName))
+{
+    group = curve->group;
+    ctx = BN_CTX_new();
+    if (ctx == nullptr)
+    {
+        throw runtime_error("Error, could not create native curve: " + curveName);
+    }
+    scratch = newPoint();
+    if (curve->ristretto)
+    {
+        torsionScratch = newPoint();
+    }
+    pippengerThreshold = curve->pippengerThreshold;
+}
+
+NativeECGroup::~NativeECGroup()
+{
+    // Points owned by this object have to be released before the group
+    scratch = NativeECPoint();
+    torsionScratch = NativeECPoint();
+    buckets.clear();
+    BN_CTX_free(ctx);
+}
+
+/**
+ * @brief Creates Curve25519 in short Weierstrass form y^2 = x^3 + ax + b (Wei25519) with the ristretto255 generator
+ *        and initializes the constants of the encoding. The point (x,y) corresponds to the Montgomery point (x - A/3, y)
+ *        and to the Edwards point (c(x - A/3)/y, (x - A/3 - 1)/(x - A/3 + 1)) with c = sqrt(-(A + 2)).
+ */
+EC_GROUP *NativeECCurve::newRistrettoGroup(BN_CTX *ctx)
+{
+    ristretto = true;
+    fieldPrime = BigNumPtr(BN_new());
+    BN_set_bit(fieldPrime.get(), 255);
+    BN_sub_word(fieldPrime.get(), 19);
+    const BIGNUM *p = fieldPrime.get();
+
+    BigNumPtr montgomeryA(BN_new());
+    BN_set_word(montgomeryA.get(), 486662);
+    BigNumPtr three(BN_new());
+    BN_set_word(three.get(), 3);
+    BigNumPtr t(BN_new());
+    BigNumPtr u(BN_new());
+
+    // A/3, a = (3 - A^2)/3 and b = (2A^3 - 9A)/27 = A/3 * (2A^2/9 - 1)
+    montgomeryAOverThree = BigNumPtr(BN_new());
+    BN_mod_inverse(t.get(), three.get(), p, ctx);
+    BN_mod_mul(montgomeryAOverThree.get(), montgomeryA.get(), t.get(), p, ctx);
+    BigNumPtr a(BN_new());
+    BN_mod_sqr(u.get(), montgomeryAOverThree.get(), p, ctx);
+    BN_mod_mul(a.get(), u.get(), three.get(), p, ctx);
+    BN_mod_sub(a.get(), BN_value_one(), a.get(), p, ctx);
+    BigNumPtr b(BN_new());
+    BN_mod_lshift1(u.get(), u.get(), p, ctx);
+    BN_mod_sub(u.get(), u.get(), BN_value_one(), p, ctx);
+    BN_mod_mul(b.get(), u.get(), montgomeryAOverThree.get(), p, ctx);
+
+    // c = sqrt(-(A + 2)), d = -121665/121666, sqrt(-1) and 1/sqrt(a - d) of the Edwards curve -x^2 + y^2 = 1 + dx^2y^2
+    edwardsScale = BigNumPtr(BN_new());
+    BN_set_word(t.get(), 486664);
+    BN_sub(t.get(), p, t.get());
+    BN_mod_sqrt(edwardsScale.get(), t.get(), p, ctx);
+    edwardsD = BigNumPtr(BN_new());
+    BN_set_word(t.get(), 121666);
+    BN_mod_inverse(t.get(), t.get(), p, ctx);
+    BN_set_word(u.get(), 121665);
+    BN_sub(u.get(), p, u.get());
+    BN_mod_mul(edwardsD.get(), u.get(), t.get(), p, ctx);
+    sqrtMinusOne = BigNumPtr(BN_new());
+    BN_sub(t.get(), p, BN_value_one());
+    BN_mod_sqrt(sqrtMinusOne.get(), t.get(), p, ctx);
+    fieldAbs(sqrtMinusOne.get(), p);
+    invSqrtAMinusD = BigNumPtr(BN_new());
+    BN_mod_add(t.get(), edwardsD.get(), BN_value_one(), p, ctx);
+    BN_sub(t.get(), p, t.get());
+    BN_mod_inverse(t.get(), t.get(), p, ctx);
+    BN_mod_sqrt(invSqrtAMinusD.get(), t.get(), p, ctx);
+    fieldAbs(invSqrtAMinusD.get(), p);
+    sqrtExponent = BigNumPtr(BN_dup(p));
+    BN_sub_word(sqrtExponent.get(), 5);
+    BN_rshift(sqrtExponent.get(), sqrtExponent.get(), 3);
+
+    // Order 2^252 + 27742317777372353535851937790883648493 and cofactor 8 of Curve25519
+    BIGNUM *groupOrder = nullptr;
+    BN_dec2bn(&groupOrder, "27742317777372353535851937790883648493");
+    BigNumPtr orderPtr(groupOrder);
+    BN_set_bit(groupOrder, 252);
+    BigNumPtr cofactor(BN_new());
+    BN_set_word(cofactor.get(), 8);
+
+    EC_GROUP *curve = EC_GROUP_new_curve_GFp(p, a.get(), b.get(), ctx);
+    if (curve == nullptr)
+    {
+        return nullptr;
+    }
+
+    // Generator of ristretto255 is the Ed25519 base point (x, 4/5) with positive x
+    BigNumPtr x(BN_new());
+    BigNumPtr y(BN_new());
+    BN_set_word(t.get(), 5);
+    BN_mod_inverse(t.get(), t.get(), p, ctx);
+    BN_set_word(u.get(), 4);
+    BN_mod_mul(y.get(), u.get(), t.get(), p, ctx);
+    BN_mod_sqr(t.get(), y.get(), p, ctx);
+    BN_mod_sub(u.get(), t.get(), BN_value_one(), p, ctx);
+    BN_mod_mul(t.get(), t.get(), edwardsD.get(), p, ctx);
+    BN_mod_add(t.get(), t.get(), BN_value_one(), p, ctx);
+    BN_mod_inverse(t.get(), t.get(), p, ctx);
+    BN_mod_mul(t.get(), u.get(), t.get(), p, ctx);
+    BN_mod_sqrt(x.get(), t.get(), p, ctx);
+    fieldAbs(x.get(), p);
+
+    // Montgomery u = (1 + y)/(1 - y), v = c * u / x
+    BN_mod_sub(t.get(), BN_value_one(), y.get(), p, ctx);
+    BN_mod_mul(t.get(), t.get(), x.get(), p, ctx);
+    BN_mod_inverse(t.get(), t.get(), p, ctx);
+    BN_mod_add(u.get(), y.get(), BN_value_one(), p, ctx);
+    BN_mod_mul(y.get(), u.get(), t.get(), p, ctx);
+    BN_mod_mul(y.get(), y.get(), edwardsScale.get(), p, ctx);
+    BN_mod_mul(x.get(), u.get(), x.get(), p, ctx);
+    BN_mod_mul(x.get(), x.get(), t.get(), p, ctx);
+    BN_mod_add(x.get(), x.get(), montgomeryAOverThree.get(), p, ctx);
+
+    EC_POINT *g = EC_POINT_new(curve);
+    bool valid = g != nullptr && EC_POINT_set_affine_coordinates(curve, g, x.get(), y.get(), ctx) == 1 &&
+                 EC_GROUP_set_generator(curve, g, groupOrder, cofactor.get()) == 1;
+    EC_POINT_free(g);
+    if (!valid)
+    {
+        EC_GROUP_free(curve);
+        return nullptr;
+    }
+    return curve;
+}
+
+void NativeECCurve::initTraceSubgroupCheck(BN_CTX *ctx)
+{
+#ifndef OPENSSL_NO_EC2M
+    const BIGNUM *cofactor = EC_GROUP_get0_cofactor(group);
+    if (EC_GROUP_get_field_type(group) != NID_X9_62_characteristic_two_field || !(BN_is_word(cofactor, 2) || BN_is_word(cofactor, 4)))
+    {
+        return;
+    }
+    fieldPolynomial = BigNumPtr(BN_new());
+    curveA = BigNumPtr(BN_new());
+    BigNumPtr curveB(BN_new());
+    EC_GROUP_get_curve(group, fieldPolynomial.get(), curveA.get(), curveB.get(), ctx);
+
+    // Tr(z^i) by Newton's identities over the coefficients f_k of the reduction polynomial:
+    // t_0 = m, t_i = i * f_(m-i) + sum_(k=1)^(i-1) f_(m-k) * t_(i-k) (mod 2)
+    int m = BN_num_bits(fieldPolynomial.get()) - 1;
+    std::vector<int> traces(m);
+    traces[0] = m & 1;
+    for (int i = 1; i < m; i++)
+    {
+        int t = (i & 1) & BN_is_bit_set(fieldPolynomial.get(), m - i);
+        for (int k = 1; k < i; k++)
+        {
+            t ^= BN_is_bit_set(fieldPolynomial.get(), m - k) & traces[i - k];
+        }
+        traces[i] = t;
+    }
+    traceMask.assign((m + 7) / 8, 0);
+    for (int i = 0; i < m; i++)
+    {
+        traceMask[traceMask.size() - 1 - i / 8] |= traces[i] << (i % 8);
+    }
+    traceOfA = fieldTrace(traceMask, curveA.get());
+    traceSubgroupCheck = true;
+#endif
+}
+
+/**
+ * @brief SQRT_RATIO_M1 of RFC 9496: r = |sqrt(u/v)| if u/v is a square, otherwise |sqrt(sqrt(-1) * u/v)|.
+ * @return true iff u/v is a square
+ */
+bool NativeECGroup::sqrtRatioM1(BIGNUM *r, const BIGNUM *u, const BIGNUM *v)
+{
+    const BIGNUM *p = curve->fieldPrime.get();
+    BN_CTX_start(ctx);
+    BIGNUM *v3 = BN_CTX_get(ctx);
+    BIGNUM *t = BN_CTX_get(ctx);
+    BIGNUM *check = BN_CTX_get(ctx);
+
+    // r = (u * v^3) * (u * v^7)^((p-5)/8)
+    BN_mod_sqr(v3, v, p, ctx);
+    BN_mod_mul(v3, v3, v, p, ctx);
+    BN_mod_sqr(t, v3, p, ctx);
+    BN_mod_mul(t, t, v, p, ctx);
+    BN_mod_mul(t, t, u, p, ctx);
+    BN_mod_exp(t, t, curve->sqrtExponent.get(), p, ctx);
+    BN_mod_mul(r, u, v3, p, ctx);
+    BN_mod_mul(r, r, t, p, ctx);
+
+    // check = v * r^2 is u, -u or -u * sqrt(-1)
+    BN_mod_sqr(check, r, p, ctx);
+    BN_mod_mul(check, check, v, p, ctx);
+    bool correctSign = BN_cmp(check, u) == 0;
+    BN_mod_add(t, check, u, p, ctx);
+    bool flippedSign = BN_is_zero(t);
+    BN_mod_mul(t, u, curve->sqrtMinusOne.get(), p, ctx);
+    BN_mod_add(t, t, check, p, ctx);
+    bool flippedSignI = BN_is_zero(t);
+    if (flippedSign || flippedSignI)
+    {
+        BN_mod_mul(r, r, curve->sqrtMinusOne.get(), p, ctx);
+    }
+    fieldAbs(r, curve->fieldPrime.get());
+
+    BN_CTX_end(ctx);
+    return correctSign || flippedSign;
+}
+
+/**
+ * @brief 4 * point = O, i.e., point is the neutral element of ristretto255.
+ */
+bool NativeECGroup::inTorsionCoset(const EC_POINT *point)
+{
+    EC_POINT_dbl(group, torsionScratch.get(), point, ctx);
+    EC_POINT_dbl(group, torsionScratch.get(), torsionScratch.get(), ctx);
+    return EC_POINT_is_at_infinity(group, torsionScratch.get()) == 1;
+}
+
+/**
+ * @brief Halving criterion for y^2 + xy = x^3 + ax^2 + b: P = (x,y) = 2Q is solvable iff Tr(x) = Tr(a).
+ *        Q = (u,v) then follows from l^2 + l = x + a with u^2 = y + (l + 1) x. As the 2-torsion is cyclic,
+ *        P is in the subgroup iff it is halvable log2(cofactor) times, and both halves of P are equally halvable.
+ */
+bool NativeECGroup::inPrimeOrderSubgroupByTrace(const EC_POINT *point)
+{
+#ifndef OPENSSL_NO_EC2M
+    if (EC_POINT_is_at_infinity(group, point))
+    {
+        return true;
+    }
+    BigNumPtr x(BN_new());
+    BigNumPtr y(BN_new());
+    EC_POINT_get_affine_coordinates(group, point, x.get(), y.get(), ctx);
+    if (fieldTrace(curve->traceMask, x.get()) != curve->traceOfA)
+    {
+        return false;
+    }
+    if (BN_is_word(EC_GROUP_get0_cofactor(group), 2))
+    {
+        return true;
+    }
+
+    BigNumPtr lambda(BN_new());
+    BigNumPtr uSquare(BN_new());
+    BN_GF2m_add(uSquare.get(), x.get(), curve->curveA.get());
+    if (BN_GF2m_mod_solve_quad(lambda.get(), uSquare.get(), curve->fieldPolynomial.get(), ctx) != 1)
+    {
+        return false;
+    }
+    BN_GF2m_add(lambda.get(), lambda.get(), BN_value_one());
+    BN_GF2m_mod_mul(uSquare.get(), lambda.get(), x.get(), curve->fieldPolynomial.get(), ctx);
+    BN_GF2m_add(uSquare.get(), uSquare.get(), y.get());
+    // Tr(u) = Tr(u^2)
+    return fieldTrace(curve->traceMask, uSquare.get()) == curve->traceOfA;
+#else
+    return false;
+#endif
+}
+
+NativeECPoint NativeECGroup::newPoint() const
+{
+    NativeECPoint p(EC_POINT_new(group));
+    if (p.get() == nullptr)
+    {
+        throw runtime_error("Error, could not allocate EC point");
+    }
+    return p;
+}
+
+void NativeECGroup::copy(NativeECPoint &r, const NativeECPoint &a) const
+{
+    if (r.get() == nullptr)
+    {
+        r = newPoint();
+    }
+    EC_POINT_copy(r.get(), a.get());
+}
+
+void NativeECGroup::setToInfinity(NativeECPoint &r) const
+{
+    EC_POINT_set_to_infinity(group, r.get());
+}
+
+bool NativeECGroup::isInfinity(const NativeECPoint &a)
+{
+    if (curve->ristretto)
+    {
+        return inTorsionCoset(a.get());
+    }
+    return EC_POINT_is_at_infinity(group, a.get()) == 1;
+}
+
+bool NativeECGroup::equals(const NativeECPoint &a, const NativeECPoint &b)
+{
+    if (curve->ristretto)
+    {
+        subtract(torsionScratch, a, b);
+        return inTorsionCoset(torsionScratch.get());
+    }
+    return EC_POINT_cmp(group, a.get(), b.get(), ctx) == 0;
+}
+
+void NativeECGroup::add(NativeECPoint &r, const NativeECPoint &a, const NativeECPoint &b)
+{
+    EC_POINT_add(group, r.get(), a.get(), b.get(), ctx);
+}
+
+void NativeECGroup::subtract(NativeECPoint &r, const NativeECPoint &a, const NativeECPoint &b)
+{
+    EC_POINT_copy(scratch.get(), b.get());
+    EC_POINT_invert(group, scratch.get(), ctx);
+    EC_POINT_add(group, r.get(), a.get(), scratch.get(), ctx);
+}
+
+void NativeECGroup::dbl(NativeECPoint &r, const NativeECPoint &a)
+{
+    EC_POINT_dbl(group, r.get(), a.get(), ctx);
+}
+
+void NativeECGroup::invert(NativeECPoint &a)
+{
+    EC_POINT_invert(group, a.get(), ctx);
+}
+
+void NativeECGroup::mul(NativeECPoint &r, const NativeECPoint &base, const BIGNUM *scalar)
+{
+    EC_POINT_mul(group, r.get(), nullptr, base.get(), scalar, ctx);
+}
+
+void NativeECGroup::mulInPlace(NativeECPoint &a, const BIGNUM *scalar)
+{
+    EC_POINT_mul(group, scratch.get(), nullptr, a.get(), scalar, ctx);
+    std::swap(a, scratch);
+}
+
+void NativeECGroup::normalize(std::vector<EC_POINT *> &points)
+{
+    if (!points.empty())
+    {
+        makeAffine(group, points, ctx);
+    }
+}
+
+void NativeECGroup::mulGenerator(NativeECPoint &r, const BIGNUM *scalar)
+{
+    EC_POINT_mul(group, r.get(), scalar, nullptr, nullptr, ctx);
+}
+
+void NativeECGroup::mulGeneratorAndPoint(NativeECPoint &r, const BIGNUM *gScalar, const NativeECPoint &base, const BIGNUM *scalar)
+{
+    EC_POINT_mul(group, r.get(), gScalar, base.get(), scalar, ctx);
+}
+
+void NativeECGroup::multiMul(NativeECPoint &r, const std::vector<const EC_POINT *> &points, const std::vector<const BIGNUM *> &scalars)
+{
+    if (points.size() != scalars.size())
+    {
+        throw invalid_argument("Error, number of points and scalars differ");
+    }
+    pointsMul(group, r.get(), points, scalars, ctx);
+}
+
+unsigned int NativeECGroup::pippengerWindowSize(size_t n)
+{
+    // ~log2(n) - 2 balances the n bucket additions per window against the 2^(w+1) additions of the bucket sum
+    unsigned int windowSize = 2;
+    while (windowSize < 16 && (size_t(1) << (windowSize + 3)) <= n)
+    {
+        windowSize++;
+    }
+    return windowSize;
+}
+
+void NativeECGroup::multiMulPair(NativeECPoint &rU, NativeECPoint &rV, const std::vector<const EC_POINT *> &uPoints,
+                                 const std::vector<const EC_POINT *> &vPoints, const std::vector<const BIGNUM *> &scalars)
+{
+    if (scalars.size() < pippengerThreshold)
+    {
+        multiMul(rU, uPoints, scalars);
+        multiMul(rV, vPoints, scalars);
+        return;
+    }
+    pippengerPair(rU, rV, uPoints, vPoints, scalars, pippengerWindowSize(scalars.size()));
+}
+
+void NativeECGroup::pippengerPair(NativeECPoint &rU, NativeECPoint &rV, const std::vector<const EC_POINT *> &uPoints,
+                                  const std::vector<const EC_POINT *> &vPoints, const std::vector<const BIGNUM *> &scalars, unsigned int windowSize)
+{
+    size_t n = scalars.size();
+    if (uPoints.size() != n || vPoints.size() != n)
+    {
+        throw invalid_argument("Error, number of points and scalars differ");
+    }
+
+    int scalarBits = 0;
+    for (auto scalar : scalars)
+    {
+        scalarBits = std::max(scalarBits, BN_num_bits(scalar));
+    }
+    size_t numberOfWindows = (scalarBits + windowSize - 1) / windowSize;
+    size_t numberOfBuckets = (size_t(1) << windowSize) - 1;
+
+    // Digits of all scalars, computed once for u and v
+    digits.assign(n * numberOfWindows, 0);
+    for (size_t i = 0; i < n; i++)
+    {
+        for (int bit = 0; bit < scalarBits; bit++)
+        {
+            if (BN_is_bit_set(scalars[i], bit))
+            {
+                digits[i * numberOfWindows + bit / windowSize] |= uint32_t(1) << (bit % windowSize);
+            }
+        }
+    }
+
+    // u buckets at [0, numberOfBuckets), v buckets at [numberOfBuckets, 2 * numberOfBuckets), then 4 running sums
+    while (buckets.size() < 2 * numberOfBuckets + 4)
+    {
+        buckets.push_back(newPoint());
+    }
+    NativeECPoint &sumU = buckets[2 * numberOfBuckets];
+    NativeECPoint &sumV = buckets[2 * numberOfBuckets + 1];
+    NativeECPoint &windowU = buckets[2 * numberOfBuckets + 2];
+    NativeECPoint &windowV = buckets[2 * numberOfBuckets + 3];
+
+    setToInfinity(rU);
+    setToInfinity(rV);
+    for (size_t window = numberOfWindows; window-- > 0;)
+    {
+        for (unsigned int d = 0; d < windowSize; d++)
+        {
+            dbl(rU, rU);
+            dbl(rV, rV);
+        }
+
+        for (size_t b = 0; b < 2 * numberOfBuckets; b++)
+        {
+            setToInfinity(buckets[b]);
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t digit = digits[i * numberOfWindows + window];
+            if (digit != 0)
+            {
+                EC_POINT_add(group, buckets[digit - 1].get(), buckets[digit - 1].get(), uPoints[i], ctx);
+                EC_POINT_add(group, buckets[numberOfBuckets + digit - 1].get(), buckets[numberOfBuckets + digit - 1].get(), vPoints[i], ctx);
+            }
+        }
+
+        // sum_d d * bucket[d] by running sums from the highest bucket down
+        setToInfinity(sumU);
+        setToInfinity(sumV);
+        setToInfinity(windowU);
+        setToInfinity(windowV);
+        for (size_t b = numberOfBuckets; b-- > 0;)
+        {
+            add(sumU, sumU, buckets[b]);
+            add(sumV, sumV, buckets[numberOfBuckets + b]);
+            add(windowU, windowU, sumU);
+            add(windowV, windowV, sumV);
+        }
+        add(rU, rU, windowU);
+        add(rV, rV, windowV);
+    }
+}
+
+size_t NativeECGroup::windowCount(int scalarBits, unsigned int windowSize)
+{
+    return (std::max(scalarBits, 1) + windowSize - 1) / windowSize + 1;
+}
+
+unsigned int NativeECGroup::tableWindowSize(size_t numberOfUses, int scalarBits, unsigned int maxWindowSize)
+{
+    // Per window: 2^(w-1) additions to build the table, (1 - 2^-w) additions per use
+    unsigned int bestWindowSize = 2;
+    double bestCost = -1;
+    for (unsigned int windowSize = 2; windowSize <= std::min(maxWindowSize, 15u); windowSize++)
+    {
+        double cost = windowCount(scalarBits, windowSize) *
+                      ((size_t(1) << (windowSize - 1)) + numberOfUses * (1.0 - 1.0 / (size_t(1) << windowSize)));
+        if (bestCost < 0 || cost < bestCost)
+        {
+            bestCost = cost;
+            bestWindowSize = windowSize;
+        }
+    }
+    return bestWindowSize;
+}
+
+void NativeECGroup::recodeScalars(NativeRecodedScalars &recoded, const std::vector<const BIGNUM *> &scalars, int scalarBits, unsigned int windowSize)
+{
+    if (windowSize < 2 || windowSize > 15)
+    {
+        throw invalid_argument("Error, window size has to be in [2,15]");
+    }
+    recoded.windowSize = windowSize;
+    recoded.numberOfWindows = windowCount(scalarBits, windowSize);
+    recoded.digits.assign(scalars.size() * recoded.numberOfWindows, 0);
+
+    int32_t windowValues = 1 << windowSize;
+    for (size_t i = 0; i < scalars.size(); i++)
+    {
+        if (BN_is_negative(scalars[i]) || BN_num_bits(scalars[i]) > scalarBits)
+        {
+            throw invalid_argument("Error, scalar too large for recoding");
+        }
+        // Digits >= 2^(w-1) become negative and carry into the next window
+        int32_t carry = 0;
+        int16_t *digits = &recoded.digits[i * recoded.numberOfWindows];
+        for (size_t window = 0; window < recoded.numberOfWindows; window++)
+        {
+            int32_t value = carry;
+            for (unsigned int bit = 0; bit < windowSize; bit++)
+            {
+                value += int32_t(BN_is_bit_set(scalars[i], int(window * windowSize + bit))) << bit;
+            }
+            carry = value >= windowValues / 2 ? 1 : 0;
+            digits[window] = int16_t(value - carry * windowValues);
+        }
+    }
+}
+
+void NativeECGroup::buildWindowTable(NativeECWindowTable &table, const NativeECPoint &base, int scalarBits, unsigned int windowSize)
+{
+    if (windowSize < 2 || windowSize > 15)
+    {
+        throw invalid_argument("Error, window size has to be in [2,15]");
+    }
+    size_t numberOfWindows = windowCount(scalarBits, windowSize);
+    size_t entriesPerWindow = size_t(1) << (windowSize - 1);
+    if (table.entries.size() != numberOfWindows * entriesPerWindow)
+    {
+        table.entries.clear();
+        for (size_t i = 0; i < numberOfWindows * entriesPerWindow; i++)
+        {
+            table.entries.push_back(newPoint());
+        }
+    }
+    table.windowSize = windowSize;
+    table.numberOfWindows = numberOfWindows;
+
+    // First entry of each window is 2^(k*w) * P = 2 * (2^(w-1) * 2^((k-1)*w) * P), the others follow by adding it
+    copy(table.entries[0], base);
+    for (size_t window = 0; window < numberOfWindows; window++)
+    {
+        NativeECPoint *windowEntries = &table.entries[window * entriesPerWindow];
+        if (window > 0)
+        {
+            dbl(windowEntries[0], table.entries[window * entriesPerWindow - 1]);
+        }
+        for (size_t d = 1; d < entriesPerWindow; d++)
+        {
+            add(windowEntries[d], windowEntries[d - 1], windowEntries[0]);
+        }
+    }
+
+    std::vector<EC_POINT *> points(table.entries.size());
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i] = table.entries[i].get();
+    }
+    normalize(points);
+}
+
+void NativeECGroup::multiMulPairWithTables(NativeECPoint &rU, NativeECPoint &rV, const std::vector<const NativeECWindowTable *> &uTables,
+                                           const std::vector<const NativeECWindowTable *> &vTables, const NativeRecodedScalars &scalars)
+{
+    if (uTables.size() != scalars.size() || vTables.size() != scalars.size())
+    {
+        throw invalid_argument("Error, number of tables and scalars differ");
+    }
+
+    setToInfinity(rU);
+    setToInfinity(rV);
+    for (size_t i = 0; i < scalars.size(); i++)
+    {
+        const NativeECWindowTable &uTable = *uTables[i];
+        const NativeECWindowTable &vTable = *vTables[i];
+        if (uTable.windowSize != scalars.windowSize || uTable.numberOfWindows < scalars.numberOfWindows ||
+            vTable.windowSize != scalars.windowSize || vTable.numberOfWindows < scalars.numberOfWindows)
+        {
+            throw invalid_argument("Error, recoded scalars do not fit the window tables");
+        }
+        const int16_t *digits = scalars.get(i);
+        for (size_t window = 0; window < scalars.numberOfWindows; window++)
+        {
+            if (digits[window] > 0)
+            {
+                add(rU, rU, uTable.get(window, digits[window]));
+                add(rV, rV, vTable.get(window, digits[window]));
+            }
+            else if (digits[window] < 0)
+            {
+                subtract(rU, rU, uTable.get(window, -digits[window]));
+                subtract(rV, rV, vTable.get(window, -digits[window]));
+            }
+        }
+    }
+}
+
+BigNumPtr NativeECGroup::toScalar(const biginteger &value)
+{
+    BigNumPtr scalar = bigintegerToBN(value);
+    if (BN_is_negative(scalar.get()) || BN_cmp(scalar.get(), curve->order.get()) >= 0)
+    {
+        BN_nnmod(scalar.get(), scalar.get(), curve->order.get(), ctx);
+    }
+    return scalar;
+}
+
+BigNumPtr NativeECGroup::randomScalar()
+{
+    BigNumPtr scalar(BN_new());
+    do
+    {
+        BN_priv_rand_range(scalar.get(), curve->order.get());
+    } while (BN_is_zero(scalar.get()));
+    return scalar;
+}
+
+void NativeECGroup::setAffine(NativeECPoint &p, const std::string &x, const std::string &y, bool checkMembership)
+{
+    BIGNUM *bnX = nullptr;
+    BIGNUM *bnY = nullptr;
+    // BN_dec2bn returns the number of characters parsed, 0 (and no BIGNUM) for invalid input, and stops at the first non-digit
+    int parsedX = BN_dec2bn(&bnX, x.c_str());
+    int parsedY = BN_dec2bn(&bnY, y.c_str());
+    BigNumPtr xPtr(bnX);
+    BigNumPtr yPtr(bnY);
+    if (parsedX == 0 || parsedY == 0 || size_t(parsedX) != x.size() || size_t(parsedY) != y.size() ||
+        BN_is_negative(bnX) || BN_is_negative(bnY))
+    {
+        throw invalid_argument("Error, point coordinates must be non-negative decimal numbers");
+    }
+
+    if (p.get() == nullptr)
+    {
+        p = newPoint();
+    }
+
+    if (BN_is_zero(bnX) && BN_is_zero(bnY))
+    {
+        setToInfinity(p);
+        return;
+    }
+
+    // OpenSSL rejects points which are not on the curve
+    if (EC_POINT_set_affine_coordinates(group, p.get(), bnX, bnY, ctx) != 1)
+    {
+        throw invalid_argument("Error, point is not on the curve " + curve->curveName);
+    }
+
+    if (checkMembership && !inPrimeOrderSubgroup({p.get()}))
+    {
+        throw invalid_argument("Error, point is not in the prime order subgroup of " + curve->curveName);
+    }
+}
+
+void NativeECGroup::setAffine(NativeECPoint &p, const biginteger &x, const biginteger &y, bool checkMembership)
+{
+    setAffine(p, x.str(), y.str(), checkMembership);
+}
+
+std::pair<biginteger, biginteger> NativeECGroup::getAffine(const NativeECPoint &p)
+{
+    if (isInfinity(p))
+    {
+        return std::make_pair(biginteger(0), biginteger(0));
+    }
+    BigNumPtr x(BN_new());
+    BigNumPtr y(BN_new());
+    EC_POINT_get_affine_coordinates(group, p.get(), x.get(), y.get(), ctx);
+    return std::make_pair(bnToBiginteger(x.get()), bnToBiginteger(y.get()));
+}
+
+std::string NativeECGroup::encode(const NativeECPoint &p)
+{
+    if (curve->ristretto)
+    {
+        static const char hexDigits[] = "0123456789abcdef";
+        unsigned char encoding[RISTRETTO255_ENCODING_OCTETS];
+        toRistretto(p, encoding);
+        std::string hex(2 * RISTRETTO255_ENCODING_OCTETS, '0');
+        for (size_t i = 0; i < RISTRETTO255_ENCODING_OCTETS; i++)
+        {
+            hex[2 * i] = hexDigits[encoding[i] >> 4];
+            hex[2 * i + 1] = hexDigits[encoding[i] & 15];
+        }
+        return hex;
+    }
+    if (isInfinity(p))
+    {
+        return "0:0";
+    }
+    BigNumPtr x(BN_new());
+    BigNumPtr y(BN_new());
+    EC_POINT_get_affine_coordinates(group, p.get(), x.get(), y.get(), ctx);
+
+    char *decX = BN_bn2dec(x.get());
+    char *decY = BN_bn2dec(y.get());
+    std::string encoded = std::string(decX) + ":" + std::string(decY);
+    OPENSSL_free(decX);
+    OPENSSL_free(decY);
+    return encoded;
+}
+
+void NativeECGroup::decode(NativeECPoint &p, const std::string &encoded, bool checkMembership)
+{
+    if (!curve->ristretto)
+    {
+        auto separator = encoded.find(':');
+        if (separator == std::string::npos)
+        {
+            throw invalid_argument("Error, point encoding has to be x:y");
+        }
+        setAffine(p, encoded.substr(0, separator), encoded.substr(separator + 1), checkMembership);
+        return;
+    }
+
+    if (encoded.size() != 2 * RISTRETTO255_ENCODING_OCTETS)
+    {
+        throw invalid_argument("Error, ristretto255 encoding has to be " + std::to_string(2 * RISTRETTO255_ENCODING_OCTETS) + " hex digits");
+    }
+    unsigned char encoding[RISTRETTO255_ENCODING_OCTETS];
+    for (size_t i = 0; i < 2 * RISTRETTO255_ENCODING_OCTETS; i++)
+    {
+        char c = encoded[i];
+        int nibble = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (nibble < 0)
+        {
+            throw invalid_argument("Error, ristretto255 encoding is not hex");
+        }
+        encoding[i / 2] = (unsigned char)((i % 2 == 0) ? nibble << 4 : encoding[i / 2] | nibble);
+    }
+    fromRistretto(p, encoding);
+}
+
+/**
+ * @brief ENCODE of RFC 9496 on the extended Edwards coordinates (X0 : Y0 : Z0 : T0) of p, which are
+ *        X0 = c u (u + 1), Y0 = (u - 1) v, Z0 = (u + 1) v, T0 = c u (u - 1) for the Montgomery point (u, v), no inversion needed.
+ */
+void NativeECGroup::toRistretto(const NativeECPoint &p, unsigned char *encoding)
+{
+    if (!curve->ristretto)
+    {
+        throw invalid_argument("Error, " + curve->curveName + " has no ristretto255 encoding");
+    }
+    if (inTorsionCoset(p.get()))
+    {
+        std::fill(encoding, encoding + RISTRETTO255_ENCODING_OCTETS, 0);
+        return;
+    }
+
+    const BIGNUM *fp = curve->fieldPrime.get();
+    BN_CTX_start(ctx);
+    BIGNUM *u = BN_CTX_get(ctx);
+    BIGNUM *v = BN_CTX_get(ctx);
+    BIGNUM *x0 = BN_CTX_get(ctx);
+    BIGNUM *y0 = BN_CTX_get(ctx);
+    BIGNUM *z0 = BN_CTX_get(ctx);
+    BIGNUM *t0 = BN_CTX_get(ctx);
+    BIGNUM *u1 = BN_CTX_get(ctx);
+    BIGNUM *u2 = BN_CTX_get(ctx);
+    BIGNUM *t = BN_CTX_get(ctx);
+    BIGNUM *invSqrt = BN_CTX_get(ctx);
+    BIGNUM *den1 = BN_CTX_get(ctx);
+    BIGNUM *den2 = BN_CTX_get(ctx);
+    BIGNUM *zInv = BN_CTX_get(ctx);
+
+    EC_POINT_get_affine_coordinates(group, p.get(), u, v, ctx);
+    BN_mod_sub(u, u, curve->montgomeryAOverThree.get(), fp, ctx);
+    BN_mod_add(t, u, BN_value_one(), fp, ctx);
+    BN_mod_sub(u1, u, BN_value_one(), fp, ctx);
+    BN_mod_mul(x0, u, curve->edwardsScale.get(), fp, ctx);
+    BN_mod_mul(t0, x0, u1, fp, ctx);
+    BN_mod_mul(x0, x0, t, fp, ctx);
+    BN_mod_mul(y0, u1, v, fp, ctx);
+    BN_mod_mul(z0, t, v, fp, ctx);
+
+    // u1 = (Z0 + Y0)(Z0 - Y0), u2 = X0 Y0, invSqrt = 1/sqrt(u1 u2^2)
+    BN_mod_add(t, z0, y0, fp, ctx);
+    BN_mod_sub(u1, z0, y0, fp, ctx);
+    BN_mod_mul(u1, u1, t, fp, ctx);
+    BN_mod_mul(u2, x0, y0, fp, ctx);
+    BN_mod_sqr(t, u2, fp, ctx);
+    BN_mod_mul(t, t, u1, fp, ctx);
+    sqrtRatioM1(invSqrt, BN_value_one(), t);
+    BN_mod_mul(den1, invSqrt, u1, fp, ctx);
+    BN_mod_mul(den2, invSqrt, u2, fp, ctx);
+    BN_mod_mul(zInv, den1, den2, fp, ctx);
+    BN_mod_mul(zInv, zInv, t0, fp, ctx);
+
+    // Rotate by sqrt(-1) if T0 * zInv is negative, den2 becomes den1 * INVSQRT_A_MINUS_D then
+    BN_mod_mul(t, t0, zInv, fp, ctx);
+    if (BN_is_odd(t))
+    {
+        BN_mod_mul(t, y0, curve->sqrtMinusOne.get(), fp, ctx);
+        BN_mod_mul(y0, x0, curve->sqrtMinusOne.get(), fp, ctx);
+        BN_copy(x0, t);
+        BN_mod_mul(den2, den1, curve->invSqrtAMinusD.get(), fp, ctx);
+    }
+    BN_mod_mul(t, x0, zInv, fp, ctx);
+    if (BN_is_odd(t) && !BN_is_zero(y0))
+    {
+        BN_sub(y0, fp, y0);
+    }
+
+    // s = |den2 * (Z0 - Y0)|
+    BN_mod_sub(t, z0, y0, fp, ctx);
+    BN_mod_mul(t, t, den2, fp, ctx);
+    fieldAbs(t, curve->fieldPrime.get());
+    BN_bn2lebinpad(t, encoding, RISTRETTO255_ENCODING_OCTETS);
+    BN_CTX_end(ctx);
+}
+
+/**
+ * @brief DECODE of RFC 9496, the Edwards point (x, y) is mapped back to the Montgomery point ((1 + y)/(1 - y), c (1 + y)/((1 - y) x)).
+ */
+void NativeECGroup::fromRistretto(NativeECPoint &p, const unsigned char *encoding)
+{
+    if (!curve->ristretto)
+    {
+        throw invalid_argument("Error, " + curve->curveName + " has no ristretto255 encoding");
+    }
+    if (p.get() == nullptr)
+    {
+        p = newPoint();
+    }
+
+    const BIGNUM *fp = curve->fieldPrime.get();
+    BN_CTX_start(ctx);
+    BIGNUM *s = BN_CTX_get(ctx);
+    BIGNUM *u1 = BN_CTX_get(ctx);
+    BIGNUM *u2 = BN_CTX_get(ctx);
+    BIGNUM *u2Square = BN_CTX_get(ctx);
+    BIGNUM *v = BN_CTX_get(ctx);
+    BIGNUM *t = BN_CTX_get(ctx);
+    BIGNUM *invSqrt = BN_CTX_get(ctx);
+    BIGNUM *denX = BN_CTX_get(ctx);
+    BIGNUM *x = BN_CTX_get(ctx);
+    BIGNUM *y = BN_CTX_get(ctx);
+
+    BN_lebin2bn(encoding, RISTRETTO255_ENCODING_OCTETS, s);
+    bool valid = BN_cmp(s, fp) < 0 && !BN_is_odd(s);
+    if (valid)
+    {
+        // u1 = 1 - s^2, u2 = 1 + s^2, v = -(d u1^2) - u2^2
+        BN_mod_sqr(t, s, fp, ctx);
+        BN_mod_sub(u1, BN_value_one(), t, fp, ctx);
+        BN_mod_add(u2, BN_value_one(), t, fp, ctx);
+        BN_mod_sqr(u2Square, u2, fp, ctx);
+        BN_mod_sqr(v, u1, fp, ctx);
+        BN_mod_mul(v, v, curve->edwardsD.get(), fp, ctx);
+        BN_mod_add(v, v, u2Square, fp, ctx);
+        if (!BN_is_zero(v))
+        {
+            BN_sub(v, fp, v);
+        }
+        BN_mod_mul(t, v, u2Square, fp, ctx);
+        valid = sqrtRatioM1(invSqrt, BN_value_one(), t);
+
+        // x = |2 s invSqrt u2|, y = u1 invSqrt^2 u2 v
+        BN_mod_mul(denX, invSqrt, u2, fp, ctx);
+        BN_mod_mul(x, s, denX, fp, ctx);
+        BN_mod_lshift1(x, x, fp, ctx);
+        fieldAbs(x, curve->fieldPrime.get());
+        BN_mod_mul(y, invSqrt, denX, fp, ctx);
+        BN_mod_mul(y, y, v, fp, ctx);
+        BN_mod_mul(y, y, u1, fp, ctx);
+        BN_mod_mul(t, x, y, fp, ctx);
+        valid = valid && !BN_is_odd(t) && !BN_is_zero(y);
+    }
+    if (!valid)
+    {
+        BN_CTX_end(ctx);
+        throw invalid_argument("Error, invalid ristretto255 encoding");
+    }
+
+    if (BN_is_zero(x))
+    {
+        // Only s = 0, the neutral element
+        setToInfinity(p);
+    }
+    else
+    {
+        BN_mod_sub(t, BN_value_one(), y, fp, ctx);
+        BN_mod_mul(t, t, x, fp, ctx);
+        BN_mod_inverse(t, t, fp, ctx);
+        BN_mod_add(y, y, BN_value_one(), fp, ctx);
+        BN_mod_mul(y, y, t, fp, ctx);
+        BN_mod_mul(u1, y, x, fp, ctx);
+        BN_mod_add(u1, u1, curve->montgomeryAOverThree.get(), fp, ctx);
+        BN_mod_mul(y, y, curve->edwardsScale.get(), fp, ctx);
+        EC_POINT_set_affine_coordinates(group, p.get(), u1, y, ctx);
+    }
+    BN_CTX_end(ctx);
+}
+
+bool NativeECGroup::inPrimeOrderSubgroup(const std::vector<const EC_POINT *> &points, unsigned int repetitions)
+{
+    if (curve->ristretto || BN_is_one(EC_GROUP_get0_cofactor(group)))
+    {
+        return true;
+    }
+
+    if (curve->traceSubgroupCheck)
+    {
+        for (auto point : points)
+        {
+            if (!inPrimeOrderSubgroupByTrace(point))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Exact check, cheaper than the subset sums for small batches
+    if (points.size() <= repetitions)
+    {
+        NativeECPoint check = newPoint();
+        for (auto point : points)
+        {
+            EC_POINT_mul(group, check.get(), nullptr, point, curve->order.get(), ctx);
+            if (!isInfinity(check))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<unsigned char> coins((points.size() * repetitions + 7) / 8);
+    if (RAND_bytes(coins.data(), int(coins.size())) != 1)
+    {
+        throw runtime_error("Error, could not sample randomness for the subgroup check");
+    }
+
+    // The points are affine, so every addition to a subset sum is a mixed addition
+    std::vector<NativeECPoint> subsetSums;
+    for (unsigned int k = 0; k < repetitions; k++)
+    {
+        subsetSums.push_back(newPoint());
+        setToInfinity(subsetSums.back());
+    }
+    size_t coin = 0;
+    for (auto point : points)
+    {
+        for (unsigned int k = 0; k < repetitions; k++, coin++)
+        {
+            if ((coins[coin / 8] >> (coin % 8)) & 1)
+            {
+                EC_POINT_add(group, subsetSums[k].get(), subsetSums[k].get(), point, ctx);
+            }
+        }
+    }
+
+    for (auto &subsetSum : subsetSums)
+    {
+        mulInPlace(subsetSum, curve->order.get());
+        if (!isInfinity(subsetSum))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t NativeECGroup::getPointOctets() const
+{
+    return 1 + 2 * ((EC_GROUP_get_degree(group) + 7) / 8);
+}
+
+void NativeECGroup::toOctets(const NativeECPoint &p, unsigned char *buffer)
+{
+    if (EC_POINT_is_at_infinity(group, p.get()))
+    {
+        std::fill(buffer, buffer + getPointOctets(), 0);
+        return;
+    }
+    if (EC_POINT_point2oct(group, p.get(), POINT_CONVERSION_UNCOMPRESSED, buffer, getPointOctets(), ctx) != getPointOctets())
+    {
+        throw invalid_argument("Error, cannot encode point of " + curve->curveName);
+    }
+}
+
+void NativeECGroup::fromOctets(NativeECPoint &p, const unsigned char *buffer)
+{
+    if (buffer[0] == 0)
+    {
+        setToInfinity(p);
+        return;
+    }
+    if (EC_POINT_oct2point(group, p.get(), buffer, getPointOctets(), ctx) != 1)
+    {
+        throw invalid_argument("Error, point is not on the curve " + curve->curveName);
+    }
+}
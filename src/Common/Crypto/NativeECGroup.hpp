@@ -0,0 +1,400 @@
+/**
+ * @file NativeECGroup.hpp
+ *
+ * @brief Thin elliptic curve group layer directly on top of OpenSSL's EC_POINT/BIGNUM API.
+ * @version 0.1
+ *
+ * Used as the native backend of AddHomElGamalEnc to avoid the libscapi GroupElement objects
+ * (shared_ptr allocation, affine normalization and dynamic casts on every group operation).
+ */
+#pragma once
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/objects.h>
+#include <openssl/rand.h>
+#include <map>
+#include <mutex>
+#include "infra/Common.hpp"
+
+struct BigNumDeleter
+{
+    void operator()(BIGNUM *bn) const { BN_clear_free(bn); }
+};
+
+typedef std::unique_ptr<BIGNUM, BigNumDeleter> BigNumPtr;
+
+// Minimum number of points for which the Pippenger multiplication beats OpenSSL's EC_POINTs_mul on generic curves
+#ifndef PIPPENGER_THRESHOLD
+#define PIPPENGER_THRESHOLD 256
+#endif
+
+// Number of random subset sums of the batched subgroup check, a point outside the subgroup passes with probability 2^-repetitions
+#ifndef SUBGROUP_CHECK_REPETITIONS
+#define SUBGROUP_CHECK_REPETITIONS 40
+#endif
+
+// Curve name of the prime order group ristretto255 (RFC 9496) on top of Curve25519
+#define RISTRETTO255_CURVE_NAME "ristretto255"
+
+// Length of the ristretto255 encoding of a group element
+#define RISTRETTO255_ENCODING_OCTETS 32
+
+/**
+ * @brief Owning handle of an OpenSSL EC_POINT.
+ *        Points are kept in whatever (projective) representation OpenSSL uses internally,
+ *        they are only normalized to affine coordinates when they are encoded.
+ *        Move-only, use NativeECGroup::copy for deep copies.
+ */
+class NativeECPoint
+{
+private:
+    EC_POINT *point;
+
+public:
+    NativeECPoint() : point(nullptr) {}
+
+    explicit NativeECPoint(EC_POINT *point) : point(point) {}
+
+    NativeECPoint(const NativeECPoint &) = delete;
+    NativeECPoint &operator=(const NativeECPoint &) = delete;
+
+    NativeECPoint(NativeECPoint &&other) noexcept : point(other.point)
+    {
+        other.point = nullptr;
+    }
+
+    NativeECPoint &operator=(NativeECPoint &&other) noexcept
+    {
+        if (this != &other)
+        {
+            EC_POINT_clear_free(point);
+            point = other.point;
+            other.point = nullptr;
+        }
+        return *this;
+    }
+
+    ~NativeECPoint()
+    {
+        EC_POINT_clear_free(point);
+    }
+
+    EC_POINT *get() { return point; }
+    const EC_POINT *get() const { return point; }
+};
+
+/**
+ * @brief Fixed-base window table of a point P for signed window digits:
+ *        entry (k, d) holds d * 2^(k*w) * P for d in [1, 2^(w-1)], negative digits subtract the entry of -d.
+ *        A multiplication with a scalar of numberOfWindows signed digits then only needs one addition per non-zero digit.
+ */
+struct NativeECWindowTable
+{
+    unsigned int windowSize = 0;
+    size_t numberOfWindows = 0;
+    std::vector<NativeECPoint> entries; // 2^(w-1) entries per window
+
+    const NativeECPoint &get(size_t window, uint32_t digit) const
+    {
+        return entries[window * (size_t(1) << (windowSize - 1)) + digit - 1];
+    }
+};
+
+/**
+ * @brief Scalars recoded into signed window digits in [-2^(w-1), 2^(w-1)], least significant window first.
+ *        The recoding only depends on the scalars, so it can be done once for scalars that are known in advance.
+ */
+struct NativeRecodedScalars
+{
+    unsigned int windowSize = 0;
+    size_t numberOfWindows = 0;
+    std::vector<int16_t> digits; // numberOfWindows digits per scalar
+
+    size_t size() const { return numberOfWindows == 0 ? 0 : digits.size() / numberOfWindows; }
+    const int16_t *get(size_t scalarIndex) const { return &digits[scalarIndex * numberOfWindows]; }
+};
+
+/**
+ * @brief Immutable data of a curve: the OpenSSL group with its precomputed generator table and the constants
+ *        of the subgroup check and of the ristretto255 encoding. Created once per process and curve (see get)
+ *        and shared by all NativeECGroup instances, only their scratch state is per thread.
+ *        OpenSSL only reads the EC_GROUP during point arithmetic, so concurrent use is safe.
+ */
+class NativeECCurve
+{
+private:
+    EC_GROUP *newRistrettoGroup(BN_CTX *ctx);
+    void initTraceSubgroupCheck(BN_CTX *ctx);
+
+public:
+    std::string curveName;
+    EC_GROUP *group = nullptr;
+    BigNumPtr order;
+    NativeECPoint generator;
+    size_t pippengerThreshold; // default of NativeECGroup::setPippengerThreshold
+
+    // Binary curves with cofactor 2 or 4: data of the halving criterion used for the subgroup check
+    bool traceSubgroupCheck = false;
+    BigNumPtr fieldPolynomial;
+    BigNumPtr curveA;
+    std::vector<unsigned char> traceMask; // big endian, bit i set iff Tr(z^i) = 1
+    int traceOfA = 0;
+
+    // ristretto255: field constants of the map between Wei25519 and the Edwards curve of the encoding
+    bool ristretto = false;
+    BigNumPtr fieldPrime;
+    BigNumPtr montgomeryAOverThree; // x offset between Montgomery and Weierstrass model
+    BigNumPtr edwardsScale;         // sqrt(-486664), scales the Montgomery v to the Edwards x
+    BigNumPtr edwardsD;
+    BigNumPtr sqrtMinusOne;
+    BigNumPtr invSqrtAMinusD;
+    BigNumPtr sqrtExponent; // (p - 5) / 8
+
+    explicit NativeECCurve(const std::string &curveName);
+    ~NativeECCurve();
+
+    NativeECCurve(const NativeECCurve &) = delete;
+    NativeECCurve &operator=(const NativeECCurve &) = delete;
+
+    /**
+     * @brief Returns the process-wide instance of the curve, created on first use. Thread-safe.
+     */
+    static std::shared_ptr<const NativeECCurve> get(const std::string &curveName);
+};
+
+/**
+ * @brief Elliptic curve group with compiled-in OpenSSL curve parameters.
+ *        Curves are selected by their NIST name (e.g. "P-256", "K-283"), the same names used for the libscapi groups.
+ *
+ *        RISTRETTO255_CURVE_NAME selects ristretto255, the prime order quotient group of Curve25519 by its 4-torsion.
+ *        Its points are kept in the isomorphic short Weierstrass model (Wei25519), so all OpenSSL arithmetic applies unchanged.
+ *        Only isInfinity and equals compare modulo the 4-torsion, and points are encoded with the canonical 32-byte
+ *        ristretto255 encoding. There is no libscapi counterpart of this group.
+ *        It is chosen for its short encodings and cheap membership check, not for speed: OpenSSL only has generic prime
+ *        field arithmetic for Wei25519, a scalar multiplication takes about 6 times as long as with the P-256 assembly.
+ *
+ *        The curve itself is shared (NativeECCurve), creating further instances of a curve only allocates the scratch state.
+ *
+ * @warning Not thread-safe (shares one BN_CTX and scratch points), use one instance per thread.
+ */
+class NativeECGroup
+{
+private:
+    std::shared_ptr<const NativeECCurve> curve;
+    const EC_GROUP *group; // curve->group
+    BN_CTX *ctx;
+    NativeECPoint scratch; // Temporary of the in-place operations
+    NativeECPoint torsionScratch; // Temporary of the ristretto255 comparisons
+    std::vector<NativeECPoint> buckets; // Reused bucket storage of the Pippenger multiplication
+    std::vector<uint32_t> digits;
+    size_t pippengerThreshold;
+
+    bool inTorsionCoset(const EC_POINT *point);
+    bool sqrtRatioM1(BIGNUM *r, const BIGNUM *u, const BIGNUM *v);
+    bool inPrimeOrderSubgroupByTrace(const EC_POINT *point);
+
+public:
+    explicit NativeECGroup(const std::string &curveName);
+    ~NativeECGroup();
+
+    NativeECGroup(const NativeECGroup &) = delete;
+    NativeECGroup &operator=(const NativeECGroup &) = delete;
+
+    const std::string &getCurveName() const { return curve->curveName; }
+    bool isRistretto() const { return curve->ristretto; }
+    const EC_GROUP *getGroup() const { return group; }
+    const BIGNUM *getOrder() const { return curve->order.get(); }
+    const NativeECPoint &getGenerator() const { return curve->generator; }
+    BN_CTX *getCTX() { return ctx; }
+
+    /**
+     * @brief Sets the minimum vector length of multiMulPair for the Pippenger multiplication.
+     *        Defaults to PIPPENGER_THRESHOLD on curves with OpenSSL's generic arithmetic and to never otherwise
+     *        (the assembly implementations of e.g. P-256 are faster than buckets built on the public EC_POINT API).
+     */
+    void setPippengerThreshold(size_t threshold) { pippengerThreshold = threshold; }
+    size_t getPippengerThreshold() const { return pippengerThreshold; }
+
+    /**
+     * @brief Returns a new point set to the point at infinity.
+     */
+    NativeECPoint newPoint() const;
+
+    void copy(NativeECPoint &r, const NativeECPoint &a) const;
+
+    void setToInfinity(NativeECPoint &r) const;
+
+    /**
+     * @brief True for the neutral element, for ristretto255 also for the other points of the 4-torsion.
+     */
+    bool isInfinity(const NativeECPoint &a);
+
+    bool equals(const NativeECPoint &a, const NativeECPoint &b);
+
+    /**
+     * @brief r = a + b (r may alias a or b)
+     */
+    void add(NativeECPoint &r, const NativeECPoint &a, const NativeECPoint &b);
+
+    /**
+     * @brief r = a - b (r may alias a or b)
+     */
+    void subtract(NativeECPoint &r, const NativeECPoint &a, const NativeECPoint &b);
+
+    void dbl(NativeECPoint &r, const NativeECPoint &a);
+
+    void invert(NativeECPoint &a);
+
+    /**
+     * @brief r = scalar * base
+     */
+    void mul(NativeECPoint &r, const NativeECPoint &base, const BIGNUM *scalar);
+
+    /**
+     * @brief a = scalar * a without allocating a new point
+     */
+    void mulInPlace(NativeECPoint &a, const BIGNUM *scalar);
+
+    /**
+     * @brief Converts all points to affine coordinates, sharing one field inversion (Montgomery's trick).
+     *        Further additions with normalized points are cheaper (mixed addition).
+     */
+    void normalize(std::vector<EC_POINT *> &points);
+
+    /**
+     * @brief r = scalar * g, uses the precomputed generator table
+     */
+    void mulGenerator(NativeECPoint &r, const BIGNUM *scalar);
+
+    /**
+     * @brief r = gScalar * g + scalar * base in one (interleaved) multiplication
+     */
+    void mulGeneratorAndPoint(NativeECPoint &r, const BIGNUM *gScalar, const NativeECPoint &base, const BIGNUM *scalar);
+
+    /**
+     * @brief r = sum_i scalars[i] * points[i]
+     */
+    void multiMul(NativeECPoint &r, const std::vector<const EC_POINT *> &points, const std::vector<const BIGNUM *> &scalars);
+
+    /**
+     * @brief rU = sum_i scalars[i] * uPoints[i] and rV = sum_i scalars[i] * vPoints[i] in one pass.
+     *        Uses Pippenger's bucket method for long vectors (the scalar digits are shared by both sums)
+     *        and OpenSSL's interleaved wNAF multiplication for short ones.
+     */
+    void multiMulPair(NativeECPoint &rU, NativeECPoint &rV, const std::vector<const EC_POINT *> &uPoints,
+                      const std::vector<const EC_POINT *> &vPoints, const std::vector<const BIGNUM *> &scalars);
+
+    /**
+     * @brief Pippenger bucket multiplication with the given window size in bits, see multiMulPair.
+     */
+    void pippengerPair(NativeECPoint &rU, NativeECPoint &rV, const std::vector<const EC_POINT *> &uPoints,
+                       const std::vector<const EC_POINT *> &vPoints, const std::vector<const BIGNUM *> &scalars, unsigned int windowSize);
+
+    /**
+     * @brief Window size (bucket count 2^w - 1) of the Pippenger multiplication for n points.
+     */
+    static unsigned int pippengerWindowSize(size_t n);
+
+    /**
+     * @brief Number of signed windows needed for scalars of up to scalarBits bits, including the final carry window.
+     */
+    static size_t windowCount(int scalarBits, unsigned int windowSize);
+
+    /**
+     * @brief Window size that minimizes building the tables of a point plus numberOfUses table multiplications
+     *        with scalars of scalarBits bits, at most maxWindowSize.
+     */
+    static unsigned int tableWindowSize(size_t numberOfUses, int scalarBits, unsigned int maxWindowSize);
+
+    /**
+     * @brief Recodes non-negative scalars of up to scalarBits bits into signed window digits for multiMulPairWithTables.
+     */
+    static void recodeScalars(NativeRecodedScalars &recoded, const std::vector<const BIGNUM *> &scalars, int scalarBits, unsigned int windowSize);
+
+    /**
+     * @brief Builds the window table of base for scalars of up to scalarBits bits. All entries are normalized.
+     *        Existing entries of the table are reused if it has the same dimensions.
+     */
+    void buildWindowTable(NativeECWindowTable &table, const NativeECPoint &base, int scalarBits, unsigned int windowSize);
+
+    /**
+     * @brief rU = sum_i s_i * U_i and rV = sum_i s_i * V_i using the window tables of U_i and V_i and the recoded scalars s_i.
+     *        Recoding and tables need the same window size and the tables at least as many windows as the recoding.
+     */
+    void multiMulPairWithTables(NativeECPoint &rU, NativeECPoint &rV, const std::vector<const NativeECWindowTable *> &uTables,
+                                const std::vector<const NativeECWindowTable *> &vTables, const NativeRecodedScalars &scalars);
+
+    /**
+     * @brief Converts a (possibly negative) biginteger into a scalar reduced modulo the group order.
+     */
+    BigNumPtr toScalar(const biginteger &value);
+
+    BigNumPtr randomScalar();
+
+    /**
+     * @brief Sets p to the affine point (x,y) given as decimal strings, "0:0" denotes the point at infinity (libscapi convention).
+     *
+     * @param checkMembership if true, throws invalid_argument if the point is not on the curve
+     */
+    void setAffine(NativeECPoint &p, const std::string &x, const std::string &y, bool checkMembership);
+
+    void setAffine(NativeECPoint &p, const biginteger &x, const biginteger &y, bool checkMembership);
+
+    /**
+     * @brief Returns the affine coordinates of p as biginteger, (0,0) for the point at infinity.
+     */
+    std::pair<biginteger, biginteger> getAffine(const NativeECPoint &p);
+
+    /**
+     * @brief Encodes p as "x:y" with decimal affine coordinates, the wire format of the libscapi EC elements.
+     *        ristretto255 elements are encoded as the hex string of their ristretto255 encoding instead.
+     */
+    std::string encode(const NativeECPoint &p);
+
+    /**
+     * @brief Inverse of encode, i.e., setAffine for "x:y" and the hex ristretto255 encoding for ristretto255.
+     */
+    void decode(NativeECPoint &p, const std::string &encoded, bool checkMembership);
+
+    /**
+     * @brief Writes the canonical ristretto255 encoding of p (RISTRETTO255_ENCODING_OCTETS bytes). Only for ristretto255.
+     */
+    void toRistretto(const NativeECPoint &p, unsigned char *encoding);
+
+    /**
+     * @brief Inverse of toRistretto, throws invalid_argument for non-canonical or invalid encodings.
+     */
+    void fromRistretto(NativeECPoint &p, const unsigned char *encoding);
+
+    /**
+     * @brief Checks that all points lie in the prime order subgroup. Always true for curves with cofactor 1,
+     *        their points are already checked to be on the curve when they are set, and for ristretto255,
+     *        where every valid encoding decodes to a group element.
+     *
+     *        For the binary NIST curves (cofactor 2 or 4) the check is exact and needs no scalar multiplication:
+     *        P is in the subgroup iff it can be halved log2(cofactor) times, which is decided by field traces.
+     *        Other curves fall back to n * S_k = O for random subset sums S_k of the points,
+     *        a point outside the subgroup passes with probability at most 2^-repetitions.
+     */
+    bool inPrimeOrderSubgroup(const std::vector<const EC_POINT *> &points, unsigned int repetitions = SUBGROUP_CHECK_REPETITIONS);
+
+    /**
+     * @brief Length of the uncompressed binary point encoding 04||x||y.
+     */
+    size_t getPointOctets() const;
+
+    /**
+     * @brief Writes the uncompressed binary encoding of p into buffer, which has getPointOctets() bytes.
+     *        The point at infinity is written as getPointOctets() zero bytes.
+     */
+    void toOctets(const NativeECPoint &p, unsigned char *buffer);
+
+    /**
+     * @brief Inverse of toOctets, throws invalid_argument if the point is not on the curve.
+     */
+    void fromOctets(NativeECPoint &p, const unsigned char *buffer);
+};
+
+BigNumPtr bigintegerToBN(const biginteger &value);
+
+biginteger bnToBiginteger(const BIGNUM *bn);
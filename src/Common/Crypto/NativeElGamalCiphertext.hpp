@@ -0,0 +1,59 @@
+/**
+ * @file NativeElGamalCiphertext.hpp
+ *
+ * @version 0.1
+ *
+ */
+#pragma once
+#include "mid_layer/AsymmetricEnc.hpp"
+#include "NativeECGroup.hpp"
+
+/**
+ * @brief Sendable data of a native ciphertext. Uses the same "u_x:u_y:v_x:v_y" string format
+ *        as the libscapi ElGamalOnGrElSendableData so both backends can talk to each other.
+ */
+class NativeElGamalSendableData : public AsymmetricCiphertextSendableData
+{
+private:
+    std::string encoded;
+
+public:
+    NativeElGamalSendableData(std::string &&encoded) : encoded(std::move(encoded)) {}
+
+    std::string toString() override { return encoded; }
+
+    void initFromString(const std::string &row) override { encoded = row; }
+};
+
+/**
+ * @brief ElGamal ciphertext (u,v) = (g^r, h^r * g^m) of the native backend.
+ *        Both points stay in projective form until the ciphertext is encoded.
+ *        Final, so that the typed operations of AddHomElGamalEnc are resolved statically.
+ */
+class NativeElGamalCiphertext final : public AsymmetricCiphertext
+{
+public:
+    NativeECGroup *group;
+    NativeECPoint u;
+    NativeECPoint v;
+
+    NativeElGamalCiphertext(NativeECGroup &group) : group(&group), u(group.newPoint()), v(group.newPoint()) {}
+
+    NativeElGamalCiphertext(NativeECGroup &group, NativeECPoint &&u, NativeECPoint &&v)
+        : group(&group), u(std::move(u)), v(std::move(v)) {}
+
+    bool operator==(const AsymmetricCiphertext &other) const override
+    {
+        auto otherNative = dynamic_cast<const NativeElGamalCiphertext *>(&other);
+        if (otherNative == NULL)
+        {
+            return false;
+        }
+        return group->equals(u, otherNative->u) && group->equals(v, otherNative->v);
+    }
+
+    shared_ptr<AsymmetricCiphertextSendableData> generateSendableData() override
+    {
+        return make_shared<NativeElGamalSendableData>(group->encode(u) + ":" + group->encode(v));
+    }
+};
@@ -90,40 +90,45 @@ void BatchedFHEHIPPIE::run()
 
     for (size_t binIndex = 0; binIndex < resultList.size(); binIndex++)
     {
+        runBin(binIndex);
+    }
+}
 
-        lbcrypto::Ciphertext<FHEEncType> multipliedResult;
+void BatchedFHEHIPPIE::runBin(size_t binIndex)
+{
 
-        for (size_t innerHfInd = 0; innerHfInd < vectorizedHCT.size(); innerHfInd++)
-        {
+    lbcrypto::Ciphertext<FHEEncType> multipliedResult;
 
-            lbcrypto::Ciphertext<FHEEncType> innerProductResult;
+    for (size_t innerHfInd = 0; innerHfInd < vectorizedHCT.size(); innerHfInd++)
+    {
 
-            for (size_t innerhashPos = 0; innerhashPos < vectorizedHCT[0][0].size(); innerhashPos++)
-            {
-                auto &currentEncryptedIndex = indexMatrix[innerHfInd][innerhashPos];
-                auto &currentItem = vectorizedHCT[innerHfInd][binIndex][innerhashPos];
+        lbcrypto::Ciphertext<FHEEncType> innerProductResult;
 
-                if (innerhashPos == 0)
-                {
-                    innerProductResult = cryptoContext->EvalMult(currentEncryptedIndex, currentItem);
-                }
-                else
-                {
-                    innerProductResult = cryptoContext->EvalAdd(innerProductResult,
-                                                                cryptoContext->EvalMult(currentEncryptedIndex, currentItem));
-                }
-            }
-            innerProductResult = cryptoContext->EvalAdd(innerProductResult, minusCompareElement);
-            if (innerHfInd == 0)
+        for (size_t innerhashPos = 0; innerhashPos < vectorizedHCT[0][0].size(); innerhashPos++)
+        {
+            auto &currentEncryptedIndex = indexMatrix[innerHfInd][innerhashPos];
+            auto &currentItem = vectorizedHCT[innerHfInd][binIndex][innerhashPos];
+
+            if (innerhashPos == 0)
             {
-                multipliedResult = innerProductResult;
+                innerProductResult = cryptoContext->EvalMult(currentEncryptedIndex, currentItem);
             }
             else
             {
-                multipliedResult = cryptoContext->EvalMult(multipliedResult, innerProductResult);
+                innerProductResult = cryptoContext->EvalAdd(innerProductResult,
+                                                            cryptoContext->EvalMult(currentEncryptedIndex, currentItem));
             }
         }
-        multipliedResult = cryptoContext->EvalMult(multipliedResult, preCalcRandomMask[binIndex]);
-        resultList[binIndex] = multipliedResult;
+        innerProductResult = cryptoContext->EvalAdd(innerProductResult, minusCompareElement);
+        if (innerHfInd == 0)
+        {
+            multipliedResult = innerProductResult;
+        }
+        else
+        {
+            multipliedResult = cryptoContext->EvalMult(multipliedResult, innerProductResult);
+        }
     }
+    multipliedResult = cryptoContext->EvalMult(multipliedResult, preCalcRandomMask[binIndex]);
+    resultList[binIndex] = multipliedResult;
 }
\ No newline at end of file
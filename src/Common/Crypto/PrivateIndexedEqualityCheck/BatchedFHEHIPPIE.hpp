@@ -32,6 +32,11 @@ public:
 
     void run();
 
+    /**
+     * @brief Computes the result of bin binIndex only, run() computes all bins.
+     */
+    void runBin(size_t binIndex);
+
     vector<lbcrypto::Ciphertext<FHEEncType>> &getResultList()
     {
         return resultList;
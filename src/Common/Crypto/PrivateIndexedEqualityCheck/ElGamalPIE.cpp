@@ -14,15 +14,39 @@
 #define CHECKED
 #endif
 
+/**
+ * @brief Bit length of the largest item of a cuckoo table, i.e., the scalar size the index tables have to support
+ */
+static int maxItemBits(vector<vector<biginteger>> &table)
+{
+    int maxBits = 1;
+    for (auto &bin : table)
+    {
+        for (auto &item : bin)
+        {
+            if (item > 0)
+            {
+                maxBits = std::max(maxBits, int(msb(item)) + 1);
+            }
+        }
+    }
+    return maxBits;
+}
+
 ElGamalPIE::ElGamalPIE(AddHomElGamalEnc &cryptor,
-                       CuckooHashTable &ct) : HIPPIE(ct, ct.getBinSize() * ct.getNumberOfHashFunctions() + ct.stash.size()), cryptor(cryptor)
+                       CuckooHashTable &ct) : HIPPIE(ct, ct.getBinSize() * ct.getNumberOfHashFunctions() + ct.stash.size()), cryptor(&cryptor)
 {
 
-    shared_ptr<Plaintext> plainZero = make_shared<BigIntegerPlainText>(0);
+    // With a pool, fresh zeros are drawn on every run instead (see runNative)
     encryptedZeros = vector<shared_ptr<AsymmetricCiphertext>>(numberOfResultElements);
-    for (uint i = 0; i < numberOfResultElements; i++)
+    if (!cryptor.usesEncryptedZeroPool())
     {
-        encryptedZeros[i] = cryptor.encrypt(plainZero);
+        shared_ptr<Plaintext> plainZero = make_shared<BigIntegerPlainText>(0);
+        for (uint i = 0; i < numberOfResultElements; i++)
+        {
+            encryptedZeros[i] = cryptor.encrypt(plainZero);
+        }
+        cryptor.normalizeBatch(encryptedZeros);
     }
 
     if (precalcRandom)
@@ -50,13 +74,64 @@ ElGamalPIE::ElGamalPIE(AddHomElGamalEnc &cryptor,
             }
         }
     }
+
+    recodeItems();
+}
+
+/**
+ * @brief Offline part of the index tables: recodes all items of the cuckoo table once, the tables themselves need the index vector of the query.
+ */
+void ElGamalPIE::recodeItems()
+{
+    itemBits.clear();
+    tableWindowSizes.clear();
+    recodedItems.clear();
+    if (precalcRandom || indexTableWindowSize == 0 || !cryptor->usesNativeBackend())
+    {
+        return;
+    }
+
+    // Tables only pay off for enough bins and items well below the group order, otherwise the multi-exponentiation stays
+    int orderBits = BN_num_bits(cryptor->getNativeGroup()->getOrder());
+    for (uint hfInd = 0; hfInd < ct.getNumberOfHashFunctions(); hfInd++)
+    {
+        itemBits.push_back(maxItemBits(ct.cuckooTable[ct.getTableIndex(hfInd)]));
+        if (2 * itemBits[hfInd] > orderBits || ct.cuckooTable[ct.getTableIndex(hfInd)].size() < INDEX_TABLE_MIN_BINS)
+        {
+            itemBits.clear();
+            return;
+        }
+    }
+
+    recodedItems = vector<vector<NativeRecodedScalars>>(ct.getNumberOfHashFunctions());
+    for (uint hfInd = 0; hfInd < ct.getNumberOfHashFunctions(); hfInd++)
+    {
+        auto &table = ct.cuckooTable[ct.getTableIndex(hfInd)];
+        tableWindowSizes.push_back(NativeECGroup::tableWindowSize(table.size(), itemBits[hfInd], indexTableWindowSize));
+        recodedItems[hfInd] = vector<NativeRecodedScalars>(table.size());
+        for (size_t binIndex = 0; binIndex < table.size(); binIndex++)
+        {
+            cryptor->recodePlaintexts(recodedItems[hfInd][binIndex], table[binIndex], itemBits[hfInd], tableWindowSizes[hfInd]);
+        }
+    }
 }
 
 void ElGamalPIE::run()
 {
+    if (cryptor->usesNativeBackend())
+    {
+        runNative();
+        return;
+    }
+
     int resultIndex = 0;
     for (uint hfInd = 0; hfInd < ct.getNumberOfHashFunctions(); hfInd++)
     {
+        bool useTables = !recodedItems.empty();
+        if (useTables)
+        {
+            cryptor->buildIndexTables(indexTables, indexMatrix[hfInd], itemBits[hfInd], tableWindowSizes[hfInd]);
+        }
 
         for (size_t binIndex = 0; binIndex < ct.cuckooTable[ct.getTableIndex(hfInd)].size(); binIndex++)
         {
@@ -67,13 +142,19 @@ void ElGamalPIE::run()
             {
 
                 auto &randomn = randomness[hfInd][binIndex];
-                shuffledResultList[permutationVector[resultIndex]] = cryptor.customIndexedRandomizedEquality(indexMatrix[hfInd],
+                shuffledResultList[permutationVector[resultIndex]] = cryptor->customIndexedRandomizedEquality(indexMatrix[hfInd],
                                                                                                              ct.cuckooTable[ct.getTableIndex(hfInd)][binIndex],
                                                                                                              minusCompareElement, encryptedZeros[resultIndex].get(), randomn);
             }
+            else if (useTables)
+            {
+                shuffledResultList[permutationVector[resultIndex]] = cryptor->tabledIndexedRandomizedEquality(indexTables,
+                                                                                                             recodedItems[hfInd][binIndex],
+                                                                                                             minusCompareElement, encryptedZeros[resultIndex].get());
+            }
             else
             {
-                shuffledResultList[permutationVector[resultIndex]] = cryptor.indexedRandomizedEquality(indexMatrix[hfInd],
+                shuffledResultList[permutationVector[resultIndex]] = cryptor->indexedRandomizedEquality(indexMatrix[hfInd],
                                                                                                        ct.cuckooTable[ct.getTableIndex(hfInd)][binIndex],
                                                                                                        minusCompareElement, encryptedZeros[resultIndex].get());
                 // important
@@ -84,8 +165,135 @@ void ElGamalPIE::run()
 
     for (uint stashInd = 0; stashInd < ct.stash.size(); stashInd++)
     {
-        shuffledResultList[permutationVector[resultIndex]] = cryptor.randomizedEquality(minusCompareElement, ct.stash[stashInd], encryptedZeros[resultIndex].get());
+        shuffledResultList[permutationVector[resultIndex]] = cryptor->randomizedEquality(minusCompareElement, ct.stash[stashInd], encryptedZeros[resultIndex].get());
         // important
         resultIndex++;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Same as run, but with the typed operations of the native backend and results written in place.
+ */
+void ElGamalPIE::runNative()
+{
+    resolveNativeInputs(*cryptor, encryptedZeros, true);
+    if (cryptor->usesEncryptedZeroPool())
+    {
+        cryptor->drawEncryptedZeros(nativeZeros);
+    }
+    if (intraSplit.enabled())
+    {
+        runNativeParallel();
+        return;
+    }
+    const NativeElGamalCiphertext &minusCompare = *nativeMinusCompareElement;
+
+    int resultIndex = 0;
+    for (uint hfInd = 0; hfInd < ct.getNumberOfHashFunctions(); hfInd++)
+    {
+        bool useTables = !recodedItems.empty();
+        if (useTables)
+        {
+            cryptor->buildIndexTables(indexTables, nativeIndexMatrix[hfInd], itemBits[hfInd], tableWindowSizes[hfInd]);
+        }
+
+        auto &table = ct.cuckooTable[ct.getTableIndex(hfInd)];
+        for (size_t binIndex = 0; binIndex < table.size(); binIndex++)
+        {
+#ifdef CHECKED
+            assert(nativeIndexMatrix[hfInd].size() == table[binIndex].size());
+#endif
+            NativeElGamalCiphertext &result = *nativeResults[resultIndex];
+            const NativeElGamalCiphertext &encryptedZero = *nativeZeros[resultIndex];
+            if (precalcRandom)
+            {
+                cryptor->customIndexedRandomizedEquality(result, nativeIndexMatrix[hfInd], table[binIndex], minusCompare, encryptedZero,
+                                                        randomness[hfInd][binIndex]);
+            }
+            else if (useTables)
+            {
+                cryptor->tabledIndexedRandomizedEquality(result, indexTables, recodedItems[hfInd][binIndex], minusCompare, encryptedZero);
+            }
+            else
+            {
+                cryptor->indexedRandomizedEquality(result, nativeIndexMatrix[hfInd], table[binIndex], minusCompare, encryptedZero);
+            }
+            resultIndex++;
+        }
+    }
+
+    for (uint stashInd = 0; stashInd < ct.stash.size(); stashInd++)
+    {
+        cryptor->randomizedEquality(*nativeResults[resultIndex], minusCompare, ct.stash[stashInd]);
+        resultIndex++;
+    }
+}
+
+/**
+ * @brief runNative split on the pool (IntraPIESplit), each subtask with the cryptor of its worker: first the index tables of
+ *        all hash functions (one subtask per index ciphertext), then all bins and the stash (one subtask per result).
+ */
+void ElGamalPIE::runNativeParallel()
+{
+    const NativeElGamalCiphertext &minusCompare = *nativeMinusCompareElement;
+    bool useTables = !recodedItems.empty();
+
+    // (hfInd, binIndex) of every result in result order, the stash follows
+    vector<pair<uint, size_t>> bins;
+    vector<pair<uint, size_t>> indexEntries;
+    for (uint hfInd = 0; hfInd < ct.getNumberOfHashFunctions(); hfInd++)
+    {
+        for (size_t binIndex = 0; binIndex < ct.cuckooTable[ct.getTableIndex(hfInd)].size(); binIndex++)
+        {
+            bins.emplace_back(hfInd, binIndex);
+        }
+        for (size_t position = 0; useTables && position < nativeIndexMatrix[hfInd].size(); position++)
+        {
+            indexEntries.emplace_back(hfInd, position);
+        }
+    }
+    if (useTables)
+    {
+        parallelIndexTables.resize(ct.getNumberOfHashFunctions());
+        for (uint hfInd = 0; hfInd < ct.getNumberOfHashFunctions(); hfInd++)
+        {
+            parallelIndexTables[hfInd].uTables.resize(nativeIndexMatrix[hfInd].size());
+            parallelIndexTables[hfInd].vTables.resize(nativeIndexMatrix[hfInd].size());
+        }
+    }
+    intraSplit.forEach(indexEntries.size(), *cryptor, [this, &indexEntries](size_t entry, AddHomElGamalEnc &worker)
+                       {
+                           NativeECGroup &group = *worker.getNativeGroup();
+                           uint hfInd = indexEntries[entry].first;
+                           size_t position = indexEntries[entry].second;
+                           const NativeElGamalCiphertext &index = *nativeIndexMatrix[hfInd][position];
+                           group.buildWindowTable(parallelIndexTables[hfInd].uTables[position], index.u, itemBits[hfInd], tableWindowSizes[hfInd]);
+                           group.buildWindowTable(parallelIndexTables[hfInd].vTables[position], index.v, itemBits[hfInd], tableWindowSizes[hfInd]); });
+
+    intraSplit.forEach(bins.size() + ct.stash.size(), *cryptor, [this, &bins, &minusCompare, useTables](size_t resultIndex, AddHomElGamalEnc &worker)
+                       {
+                           NativeElGamalCiphertext &result = *nativeResults[resultIndex];
+                           if (resultIndex >= bins.size())
+                           {
+                               worker.randomizedEquality(result, minusCompare, ct.stash[resultIndex - bins.size()]);
+                               return;
+                           }
+
+                           uint hfInd = bins[resultIndex].first;
+                           size_t binIndex = bins[resultIndex].second;
+                           auto &bin = ct.cuckooTable[ct.getTableIndex(hfInd)][binIndex];
+                           const NativeElGamalCiphertext &encryptedZero = *nativeZeros[resultIndex];
+                           if (precalcRandom)
+                           {
+                               worker.customIndexedRandomizedEquality(result, nativeIndexMatrix[hfInd], bin, minusCompare, encryptedZero,
+                                                                      randomness[hfInd][binIndex]);
+                           }
+                           else if (useTables)
+                           {
+                               worker.tabledIndexedRandomizedEquality(result, parallelIndexTables[hfInd], recodedItems[hfInd][binIndex], minusCompare, encryptedZero);
+                           }
+                           else
+                           {
+                               worker.indexedRandomizedEquality(result, nativeIndexMatrix[hfInd], bin, minusCompare, encryptedZero);
+                           } });
+}
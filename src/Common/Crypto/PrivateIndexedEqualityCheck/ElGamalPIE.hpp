@@ -8,22 +8,72 @@
 #pragma once
 #include "src/Common/Crypto/AddHomElGamalEnc.hpp"
 #include "HIPPIE.hpp"
+#include "IntraPIESplit.hpp"
+
+// Maximum window size of the per-index tables used by the native backend, 0 disables them
+#ifndef INDEX_TABLE_WINDOW_SIZE
+#define INDEX_TABLE_WINDOW_SIZE 6
+#endif
+
+// Minimum number of bins (items per position) sharing the index tables, below that building the tables costs more than it saves
+#ifndef INDEX_TABLE_MIN_BINS
+#define INDEX_TABLE_MIN_BINS 8
+#endif
 
 /**
  * @brief Class
  *
  */
-class ElGamalPIE : public HIPPIE
+class ElGamalPIE final : public HIPPIE
 {
 
 private:
-    AddHomElGamalEnc &cryptor;
+    AddHomElGamalEnc *cryptor;
     vector<vector<biginteger>> randomness;
     vector<shared_ptr<AsymmetricCiphertext>> encryptedZeros;
-    bool precalcRandom;
+    bool precalcRandom = false;
+    unsigned int indexTableWindowSize = INDEX_TABLE_WINDOW_SIZE;
+    NativeIndexTables indexTables; // reused across runs
+    vector<int> itemBits;                               // [hfInd], bit length of the largest item
+    vector<unsigned int> tableWindowSizes;              // [hfInd]
+    vector<vector<NativeRecodedScalars>> recodedItems;  // [hfInd][binIndex], empty if the tables are not used
+    IntraPIESplit intraSplit;
+    vector<NativeIndexTables> parallelIndexTables; // [hfInd], the tables of runNativeParallel
+
+    void recodeItems();
+    void runNative();
+    void runNativeParallel();
 
 public:
     ElGamalPIE(AddHomElGamalEnc &cryptor, CuckooHashTable &ct);
 
+    /**
+     * @brief Sets the window size of the tables precomputed per index ciphertext, 0 disables the tables.
+     *        Tables are built once per hash function and query, the server items are recoded for them offline.
+     *        The actual window size per hash function follows the number of bins, windowSize is its upper bound.
+     */
+    void setIndexTableWindowSize(unsigned int windowSize)
+    {
+        indexTableWindowSize = windowSize;
+        recodeItems();
+    }
+
+    /**
+     * @brief Splits every run of the native backend across up to threads workers of pool (WorkStealingPool::parallelFor),
+     *        one subtask per bin and hash function, each with the cryptor of the worker that runs it.
+     *        The index tables of all hash functions are kept at once then instead of one at a time.
+     */
+    void setIntraThreads(unsigned int threads, WorkStealingPool &pool, vector<AddHomElGamalEnc> &workerCryptors)
+    {
+        intraSplit.maxWorkers = std::max(1u, threads);
+        intraSplit.pool = &pool;
+        intraSplit.workerCryptors = &workerCryptors;
+    }
+
+    /**
+     * @brief Lets the next run use cryptor, e.g., the one of the pool worker that runs it.
+     */
+    void bind(AddHomElGamalEnc &cryptor) { this->cryptor = &cryptor; }
+
     void run() override;
 };
\ No newline at end of file
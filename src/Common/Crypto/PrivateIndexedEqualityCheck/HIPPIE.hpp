@@ -6,6 +6,7 @@
  */
 #pragma once
 #include "mid_layer/AsymmetricEnc.hpp"
+#include "src/Common/Crypto/AddHomElGamalEnc.hpp"
 #include "src/Common/Hashing/CuckooHashTable.hpp"
 
 class HIPPIE
@@ -15,15 +16,83 @@ protected:
     vector<std::shared_ptr<AsymmetricCiphertext>> shuffledResultList;
     vector<uint> permutationVector;
     vector<vector<AsymmetricCiphertext *>> indexMatrix;
-    AsymmetricCiphertext *minusCompareElement;
+    AsymmetricCiphertext *minusCompareElement = nullptr;
     uint numberOfResultElements;
 
+    // Typed views for the native backend, resolved once per run so that the hot loops need no casts and no shared_ptr copies
+    vector<vector<NativeElGamalCiphertext *>> nativeIndexMatrix;
+    NativeElGamalCiphertext *nativeMinusCompareElement = nullptr;
+    vector<NativeElGamalCiphertext *> nativeZeros;   // [resultIndex]
+    vector<NativeElGamalCiphertext *> nativeResults; // [resultIndex], owned by shuffledResultList
+    vector<std::shared_ptr<NativeElGamalCiphertext>> convertedInputs; // libscapi inputs converted for the native backend
+
     void initPermutationVector(uint numberOfResultElements)
     {
         permutationVector = createPermutationVector(numberOfResultElements);
         shuffledResultList = vector<std::shared_ptr<AsymmetricCiphertext>>(numberOfResultElements);
     }
 
+    /**
+     * @brief Fills the typed views of the native backend. The result ciphertexts are allocated on the first call
+     *        and overwritten by every later run, i.e., results have to be consumed before the next run.
+     *
+     * @param encryptedZeros [resultIndex], libscapi ciphertexts are replaced by their native conversion,
+     *                       missing ones (to be drawn from a pool) are allocated
+     * @param withIndex whether the index matrix is resolved or only the compare element
+     */
+    void resolveNativeInputs(AddHomElGamalEnc &cryptor, vector<std::shared_ptr<AsymmetricCiphertext>> &encryptedZeros, bool withIndex)
+    {
+        if (nativeResults.size() != numberOfResultElements)
+        {
+            nativeZeros.resize(numberOfResultElements);
+            nativeResults.resize(numberOfResultElements);
+            for (uint i = 0; i < numberOfResultElements; i++)
+            {
+                if (!encryptedZeros[i])
+                {
+                    encryptedZeros[i] = std::make_shared<NativeElGamalCiphertext>(*cryptor.getNativeGroup());
+                }
+                unique_ptr<NativeElGamalCiphertext> converted;
+                nativeZeros[i] = cryptor.toNative(encryptedZeros[i].get(), converted);
+                if (converted)
+                {
+                    encryptedZeros[i] = std::move(converted);
+                }
+                auto result = std::make_shared<NativeElGamalCiphertext>(*cryptor.getNativeGroup());
+                nativeResults[i] = result.get();
+                shuffledResultList[permutationVector[i]] = result;
+            }
+        }
+
+        if (withIndex)
+        {
+            nativeIndexMatrix.resize(indexMatrix.size());
+            for (size_t i = 0; i < indexMatrix.size(); i++)
+            {
+                nativeIndexMatrix[i].resize(indexMatrix[i].size());
+                for (size_t j = 0; j < indexMatrix[i].size(); j++)
+                {
+                    nativeIndexMatrix[i][j] = resolveNative(cryptor, indexMatrix[i][j]);
+                }
+            }
+        }
+        if (minusCompareElement != nullptr)
+        {
+            nativeMinusCompareElement = resolveNative(cryptor, minusCompareElement);
+        }
+    }
+
+    NativeElGamalCiphertext *resolveNative(AddHomElGamalEnc &cryptor, AsymmetricCiphertext *cipher)
+    {
+        unique_ptr<NativeElGamalCiphertext> converted;
+        NativeElGamalCiphertext *nativeCipher = cryptor.toNative(cipher, converted);
+        if (converted)
+        {
+            convertedInputs.push_back(std::move(converted));
+        }
+        return nativeCipher;
+    }
+
 public:
     HIPPIE(CuckooHashTable &ct, uint numberOfResultElements) : ct(ct), numberOfResultElements(numberOfResultElements)
     {
@@ -52,4 +121,36 @@ public:
     {
         this->minusCompareElement = minusCompareElement;
     }
+
+    /**
+     * @brief Appends the received input ciphertexts that are set, e.g., for a membership check.
+     *
+     * @param withIndex whether the index matrix is included or only the compare element
+     */
+    void collectInputs(vector<AsymmetricCiphertext *> &inputs, bool withIndex = true)
+    {
+        if (withIndex)
+        {
+            for (auto &indexVector : indexMatrix)
+            {
+                inputs.insert(inputs.end(), indexVector.begin(), indexVector.end());
+            }
+        }
+        if (minusCompareElement != nullptr)
+        {
+            inputs.push_back(minusCompareElement);
+        }
+    }
+
+    /**
+     * @brief Drops the references to the input ciphertexts of the current session (owned by the session arena).
+     */
+    void clearInputs()
+    {
+        indexMatrix.clear();
+        minusCompareElement = nullptr;
+        nativeIndexMatrix.clear();
+        nativeMinusCompareElement = nullptr;
+        convertedInputs.clear();
+    }
 };
\ No newline at end of file
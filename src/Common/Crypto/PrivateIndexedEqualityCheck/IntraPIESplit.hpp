@@ -0,0 +1,43 @@
+/**
+ * @file IntraPIESplit.hpp
+ *
+ * @version 0.1
+ *
+ */
+#pragma once
+#include "src/Common/Crypto/AddHomElGamalEnc.hpp"
+#include "src/Common/WorkStealingPool.hpp"
+#include <functional>
+
+/**
+ * @brief Splits one PIE run or precomputation into subtasks (bins, index entries) on the WorkStealingPool that runs the PIEs,
+ *        i.e., the number of threads stays the number of workers. Cryptors and their EC groups are not thread-safe, every
+ *        subtask uses the cryptor of the worker that runs it.
+ */
+struct IntraPIESplit
+{
+    unsigned int maxWorkers = 1;
+    WorkStealingPool *pool = nullptr;
+    vector<AddHomElGamalEnc> *workerCryptors = nullptr; // [worker] of pool
+
+    bool enabled() const { return maxWorkers > 1 && pool != nullptr; }
+
+    /**
+     * @brief Runs body(index, cryptor) for all indices in [0, n), split across up to maxWorkers workers if enabled,
+     *        otherwise in order with cryptor.
+     */
+    void forEach(size_t n, AddHomElGamalEnc &cryptor, const std::function<void(size_t index, AddHomElGamalEnc &cryptor)> &body) const
+    {
+        if (!enabled())
+        {
+            for (size_t index = 0; index < n; index++)
+            {
+                body(index, cryptor);
+            }
+            return;
+        }
+        vector<AddHomElGamalEnc> &cryptors = *workerCryptors;
+        pool->parallelFor(n, maxWorkers, [&cryptors, &body](size_t index, size_t worker)
+                          { body(index, cryptors[worker]); });
+    }
+};
@@ -9,66 +9,251 @@
 #include "ElGamalPIE.hpp"
 #include "PrecompElGamalPIE.hpp"
 #include "FHEHIPPIE.hpp"
+#include <atomic>
+#include <mutex>
 
+/**
+ * @brief Normalizes the results of a PIE as one batch and encodes them for sending, with the cryptor of the worker that ran it.
+ *        Encoding uses the scratch state of the group, so it cannot be left to the thread that sends the results.
+ */
+inline vector<string> encodeResults(AddHomElGamalEnc &cryptor, vector<shared_ptr<AsymmetricCiphertext>> &results)
+{
+    cryptor.normalizeBatch(results);
+    vector<string> encoded(results.size());
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        encoded[i] = cryptor.encodeCiphertext(results[i].get());
+    }
+    return encoded;
+}
+
+/**
+ * @brief All ElGamal PIEs of a server and the per worker state of the WorkStealingPool that runs them as tasks.
+ *        Cryptors and arenas are not thread-safe, so every worker has its own and a PIE is bound to the ones of
+ *        the worker that runs it. Received ciphertexts are decoded by the tasks as well, into the arena of their worker.
+ */
 struct ElGamalPIECollection
 {
 
-    AddHomElGamalEnc cryptor;
-    vector<ElGamalPIE> myPIEs;
+    vector<AddHomElGamalEnc> cryptors;          // [worker]
+    vector<unique_ptr<CiphertextArena>> arenas; // [worker], own the received and created ciphertexts of the current session
+    vector<unique_ptr<ElGamalPIE>> myPIEs;
+    vector<vector<string>> encodedResults; // [pie], results of the current session, ready to be sent
+    std::atomic<bool> inputsValid{true};   // Cleared by the first PIE of the session whose membership check failed
+    unsigned int intraPIEThreads = 1;    // see ElGamalPIE::setIntraThreads
+    WorkStealingPool *pool = nullptr;    // Pool that runs the PIEs, needed to split them (intraPIEThreads > 1)
 
-    ElGamalPIECollection(AddHomElGamalEnc &&cryptor)
-        : cryptor(cryptor),
-          myPIEs(vector<ElGamalPIE>())
+    ElGamalPIECollection(vector<AddHomElGamalEnc> &&cryptors, size_t numberOfPIEs)
+        : cryptors(std::move(cryptors)),
+          myPIEs(numberOfPIEs),
+          encodedResults(numberOfPIEs)
     {
+        for (size_t worker = 0; worker < this->cryptors.size(); worker++)
+        {
+            arenas.emplace_back(new CiphertextArena());
+        }
     }
 
-    void runAll()
+    /**
+     * @brief Builds PIE pieIndex with the cryptor of worker, safe to run concurrently for different PIEs.
+     */
+    void addPIE(size_t pieIndex, CuckooHashTable &ct, size_t worker)
     {
-        for (auto &pie : myPIEs)
+        myPIEs[pieIndex].reset(new ElGamalPIE(cryptors[worker], ct));
+        if (pool != nullptr)
+        {
+            myPIEs[pieIndex]->setIntraThreads(intraPIEThreads, *pool, cryptors);
+        }
+    }
+
+    /**
+     * @brief Task of one PIE: checks its received ciphertexts as one batch and, if they are valid, runs it on worker
+     *        and encodes its results.
+     */
+    void runPIE(size_t pieIndex, size_t worker)
+    {
+        ElGamalPIE &pie = *myPIEs[pieIndex];
+        vector<AsymmetricCiphertext *> inputs;
+        pie.collectInputs(inputs);
+        if (!cryptors[worker].checkMembershipBatch(inputs))
         {
-            pie.run();
+            inputsValid = false;
+            return;
         }
+        pie.bind(cryptors[worker]);
+        pie.run();
+        encodedResults[pieIndex] = encodeResults(cryptors[worker], pie.getResultList());
     }
 
-    void addPIE(CuckooHashTable &ct)
+    /**
+     * @brief Frees all ciphertexts of the current session, the PIEs can be reused for the next one.
+     */
+    void endSession()
     {
-        myPIEs.push_back(ElGamalPIE(cryptor, ct));
+        for (auto &pie : myPIEs)
+        {
+            pie->clearInputs();
+        }
+        for (auto &encoded : encodedResults)
+        {
+            encoded.clear();
+        }
+        for (auto &arena : arenas)
+        {
+            arena->reset();
+        }
+        inputsValid = true;
     }
 };
 
+/**
+ * @brief PrecompElGamalPIE counterpart of ElGamalPIECollection. Precomputed ciphertexts stay in the arena of the worker
+ *        that precomputed them, a PIE may run on another worker.
+ */
 struct PrecompElGamalPIECollection
 {
 
-    AddHomElGamalEnc cryptor;
-    vector<PrecompElGamalPIE> myPIEs;
+    vector<AddHomElGamalEnc> cryptors;          // [worker]
+    vector<unique_ptr<CiphertextArena>> arenas; // [worker], own received, precomputed and intermediate ciphertexts of the current session
+    vector<unique_ptr<PrecompElGamalPIE>> myPIEs;
+    vector<vector<string>> encodedResults; // [pie], results of the current session, ready to be sent
+    std::atomic<bool> inputsValid{true};   // Cleared by the first PIE of the session whose membership check failed
+    bool leanPrecomp = false;            // see PrecompElGamalPIE::setLean
+    size_t precompWindow = 0;            // Lean mode: PIEs per worker precomputed ahead of the running ones, 0 precomputes all offline
+    unsigned int intraPIEThreads = 1;    // see PrecompElGamalPIE::setIntraThreads
+    WorkStealingPool *pool = nullptr;    // Pool that runs the PIEs, needed to split them (intraPIEThreads > 1)
+    vector<unique_ptr<std::mutex>> pieMutexes; // [pie], serializes the look-ahead precomputation and the run of a PIE
+    vector<unsigned char> pieDone;             // [pie], set under the mutex of the PIE once it ran in the current session
 
-    PrecompElGamalPIECollection(AddHomElGamalEnc &&cryptor)
-        : cryptor(cryptor),
-          myPIEs(vector<PrecompElGamalPIE>())
+    PrecompElGamalPIECollection(vector<AddHomElGamalEnc> &&cryptors, size_t numberOfPIEs)
+        : cryptors(std::move(cryptors)),
+          myPIEs(numberOfPIEs),
+          encodedResults(numberOfPIEs),
+          pieDone(numberOfPIEs, 0)
     {
+        for (size_t worker = 0; worker < this->cryptors.size(); worker++)
+        {
+            arenas.emplace_back(new CiphertextArena());
+        }
+        for (size_t pie = 0; pie < numberOfPIEs; pie++)
+        {
+            pieMutexes.emplace_back(new std::mutex());
+        }
     }
 
-    void runAll()
+    /**
+     * @brief Distance of the look-ahead precomputation: while PIE k runs, PIE k + precompAhead() is precomputed.
+     *        The PIEs below it are precomputed offline.
+     */
+    size_t precompAhead() const { return precompWindow * cryptors.size(); }
+
+    /**
+     * @brief Builds PIE pieIndex with the cryptor of worker, safe to run concurrently for different PIEs.
+     *        The random index matrix has to be decoded into the arena of a worker.
+     */
+    void addPIE(size_t pieIndex, CuckooHashTable &ct, vector<vector<AsymmetricCiphertext *>> &&randomIndexMatrix, size_t worker)
     {
-        for (auto &pie : myPIEs)
+        unique_ptr<PrecompElGamalPIE> mpie(new PrecompElGamalPIE(cryptors[worker], *arenas[worker], ct));
+        mpie->setLean(leanPrecomp);
+        if (pool != nullptr)
         {
-            pie.run();
+            mpie->setIntraThreads(intraPIEThreads, *pool, cryptors);
         }
+        mpie->setIndex(std::move(randomIndexMatrix));
+        myPIEs[pieIndex] = std::move(mpie);
     }
 
-    void precompAll()
+    /**
+     * @brief Offline task of one PIE: checks its random index matrix as one batch and, if it is valid and the PIE is within
+     *        the precomputation window (the first precompAhead() PIEs), precomputes it on worker.
+     */
+    void precompPIE(size_t pieIndex, size_t worker)
     {
-        for (auto &pie : myPIEs)
+        if (!checkInputs(*myPIEs[pieIndex], worker, true))
+        {
+            return;
+        }
+        if (precompWindow == 0 || pieIndex < precompAhead())
+        {
+            myPIEs[pieIndex]->bind(cryptors[worker], *arenas[worker]);
+            myPIEs[pieIndex]->precomp();
+        }
+    }
+
+    /**
+     * @brief Look-ahead task of the online phase: precomputes PIE pieIndex on worker while the earlier PIEs run.
+     *        Skipped if the PIE is already precomputed, or if its own online task got to it first (it then precomputes itself).
+     *        The precomputed octets belong to the PIE, so it may run on any worker.
+     */
+    void precompAheadPIE(size_t pieIndex, size_t worker)
+    {
+        std::unique_lock<std::mutex> lock(*pieMutexes[pieIndex], std::try_to_lock);
+        PrecompElGamalPIE &pie = *myPIEs[pieIndex];
+        if (!lock.owns_lock() || pieDone[pieIndex] || pie.isPrecomputed() || !inputsValid)
+        {
+            return;
+        }
+        pie.bind(cryptors[worker], *arenas[worker]);
+        pie.precomp();
+    }
+
+    /**
+     * @brief Online task of one PIE: checks its compare element and, if it is valid, runs it on worker and encodes its results.
+     *        With a precomputation window, a PIE whose look-ahead did not run yet is precomputed right before its run, and the
+     *        precomputation is released right after it.
+     */
+    void runPIE(size_t pieIndex, size_t worker)
+    {
+        PrecompElGamalPIE &pie = *myPIEs[pieIndex];
+        if (!checkInputs(pie, worker, false))
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(*pieMutexes[pieIndex]);
+        pie.bind(cryptors[worker], *arenas[worker]);
+        if (!pie.isPrecomputed())
         {
             pie.precomp();
         }
+        pie.run();
+        encodedResults[pieIndex] = encodeResults(cryptors[worker], pie.getResultList());
+        if (precompWindow > 0)
+        {
+            pie.releasePrecomp();
+        }
+        pieDone[pieIndex] = 1;
     }
 
-    void addPIE(CuckooHashTable &ct, vector<vector<AsymmetricCiphertext *>> &&randomIndexMatrix)
+    bool checkInputs(PrecompElGamalPIE &pie, size_t worker, bool withIndex)
     {
-        PrecompElGamalPIE mpie(cryptor, ct);
-        mpie.setIndex(std::move(randomIndexMatrix));
-        myPIEs.push_back(std::move(mpie));
+        vector<AsymmetricCiphertext *> inputs;
+        pie.collectInputs(inputs, withIndex);
+        if (!cryptors[worker].checkMembershipBatch(inputs))
+        {
+            inputsValid = false;
+        }
+        return inputsValid;
+    }
+
+    /**
+     * @brief Frees all ciphertexts of the current session, including the precomputed ones.
+     */
+    void endSession()
+    {
+        for (auto &pie : myPIEs)
+        {
+            pie->clearInputs();
+        }
+        for (auto &encoded : encodedResults)
+        {
+            encoded.clear();
+        }
+        for (auto &arena : arenas)
+        {
+            arena->reset();
+        }
+        std::fill(pieDone.begin(), pieDone.end(), 0);
+        inputsValid = true;
     }
 };
 
@@ -76,24 +261,24 @@ struct FHEHIPPIECollection
 {
     lbcrypto::CryptoContext<lbcrypto::DCRTPoly> &cryptor;
     lbcrypto::PublicKey<FHEEncType> &pK;
-    vector<FHEHIPPIE> myPIEs;
+    vector<unique_ptr<FHEHIPPIE>> myPIEs;
 
-    FHEHIPPIECollection(lbcrypto::CryptoContext<lbcrypto::DCRTPoly> &cryptor, lbcrypto::PublicKey<FHEEncType> &pK)
+    FHEHIPPIECollection(lbcrypto::CryptoContext<lbcrypto::DCRTPoly> &cryptor, lbcrypto::PublicKey<FHEEncType> &pK, size_t numberOfPIEs)
         : cryptor(cryptor), pK(pK),
-          myPIEs(vector<FHEHIPPIE>())
+          myPIEs(numberOfPIEs)
     {
     }
 
-    void runAll()
+    /**
+     * @brief Builds PIE pieIndex, safe to run concurrently for different PIEs.
+     */
+    void addPIE(size_t pieIndex, CuckooHashTable &ct)
     {
-        for (auto &pie : myPIEs)
-        {
-            pie.run();
-        }
+        myPIEs[pieIndex].reset(new FHEHIPPIE(cryptor, pK, ct));
     }
 
-    void addPIE(CuckooHashTable &ct)
+    void runPIE(size_t pieIndex)
     {
-        myPIEs.push_back(FHEHIPPIE(cryptor, pK, ct));
+        myPIEs[pieIndex]->run();
     }
 };
\ No newline at end of file
@@ -7,25 +7,21 @@
  */
 #include "PrecompElGamalPIE.hpp"
 
-PrecompElGamalPIE::PrecompElGamalPIE(AddHomElGamalEnc &cryptor, CuckooHashTable &ct) : HIPPIE(ct, ct.getBinSize() * ct.getNumberOfHashFunctions() + ct.stash.size()),
-                                                                                       cryptor(cryptor)
+PrecompElGamalPIE::PrecompElGamalPIE(AddHomElGamalEnc &cryptor, CiphertextArena &arena, CuckooHashTable &ct) : HIPPIE(ct, ct.getBinSize() * ct.getNumberOfHashFunctions() + ct.stash.size()),
+                                                                                                                cryptor(&cryptor), arena(&arena)
 {
 
-    shared_ptr<Plaintext> plainZero = make_shared<BigIntegerPlainText>(0);
+    // With a pool, fresh zeros are drawn on every run instead (see runNative)
     encryptedZeros = vector<shared_ptr<AsymmetricCiphertext>>(numberOfResultElements);
-    for (uint i = 0; i < numberOfResultElements; i++)
+    if (!cryptor.usesEncryptedZeroPool())
     {
-        encryptedZeros[i] = cryptor.encrypt(plainZero);
+        shared_ptr<Plaintext> plainZero = make_shared<BigIntegerPlainText>(0);
+        for (uint i = 0; i < numberOfResultElements; i++)
+        {
+            encryptedZeros[i] = cryptor.encrypt(plainZero);
+        }
+        cryptor.normalizeBatch(encryptedZeros);
     }
-
-    // Ugly
-    encryptedMessageMatrix = vector<vector<vector<AsymmetricCiphertext *>>>(ct.getNumberOfHashFunctions(),
-                                                                            vector<vector<AsymmetricCiphertext *>>(ct.cuckooTable[0].size(),
-                                                                                                                   vector<AsymmetricCiphertext *>(ct.cuckooTable[0][0].size())));
-
-    negatedMessageMatrix = vector<vector<vector<AsymmetricCiphertext *>>>(ct.getNumberOfHashFunctions(),
-                                                                          vector<vector<AsymmetricCiphertext *>>(ct.cuckooTable[0].size(),
-                                                                                                                 vector<AsymmetricCiphertext *>(ct.cuckooTable[0][0].size())));
 }
 
 void PrecompElGamalPIE::precomp()
@@ -36,6 +32,29 @@ void PrecompElGamalPIE::precomp()
 
         throw logic_error("Index Matrix not set when try to precompute.");
     }
+    precomputed = true;
+    if (usesLean())
+    {
+        precompLean();
+        return;
+    }
+
+    // Ugly, the pointer matrices are only needed outside of the lean mode
+    if (encryptedMessageMatrix.empty())
+    {
+        encryptedMessageMatrix = vector<vector<vector<AsymmetricCiphertext *>>>(ct.getNumberOfHashFunctions(),
+                                                                                vector<vector<AsymmetricCiphertext *>>(ct.cuckooTable[0].size(),
+                                                                                                                       vector<AsymmetricCiphertext *>(ct.cuckooTable[0][0].size())));
+
+        negatedMessageMatrix = vector<vector<vector<AsymmetricCiphertext *>>>(ct.getNumberOfHashFunctions(),
+                                                                              vector<vector<AsymmetricCiphertext *>>(ct.cuckooTable[0].size(),
+                                                                                                                     vector<AsymmetricCiphertext *>(ct.cuckooTable[0][0].size())));
+    }
+    if (cryptor->usesNativeBackend())
+    {
+        precompNative();
+        return;
+    }
 
     // Exponentiate indexVector
     for (size_t i = 0; i < indexMatrix.size(); i++)
@@ -47,8 +66,8 @@ void PrecompElGamalPIE::precomp()
             for (size_t k = 0; k < ct.getBinSize(); k++)
             {
 
-                encryptedMessageMatrix[i][k][j] = cryptor.multByConstPointer(indexMatrix[i][j], ct.cuckooTable[ct.getTableIndex(i)][k][j]);
-                negatedMessageMatrix[i][k][j] = cryptor.elementXorByConstPointer(encryptedMessageMatrix[i][k][j], ct.cuckooTable[ct.getTableIndex(i)][k][j]);
+                encryptedMessageMatrix[i][k][j] = cryptor->multByConstPointer(indexMatrix[i][j], ct.cuckooTable[ct.getTableIndex(i)][k][j], arena);
+                negatedMessageMatrix[i][k][j] = cryptor->elementXorByConstPointer(encryptedMessageMatrix[i][k][j], ct.cuckooTable[ct.getTableIndex(i)][k][j], arena);
             }
         }
     }
@@ -61,6 +80,16 @@ void PrecompElGamalPIE::setBitVector(boost::dynamic_bitset<unsigned char> &&xorV
 
 void PrecompElGamalPIE::run()
 {
+    if (usesLean())
+    {
+        runLean();
+        return;
+    }
+    if (cryptor->usesNativeBackend())
+    {
+        runNative();
+        return;
+    }
 
     int resultIndex = 0;
     int bitVectorIndex = 0;
@@ -73,35 +102,32 @@ void PrecompElGamalPIE::run()
             assert(indexMatrix[hfInd].size() == ct.cuckooTable[ct.getTableIndex(hfInd)][binIndex].size());
 #endif
 
-            // Result elem init
+            // Result elem init, the accumulator is a copy so the precomputed matrices stay untouched
             AsymmetricCiphertext *addUp;
             if (xorVector[bitVectorIndex])
             {
-                addUp = negatedMessageMatrix[hfInd][binIndex][0];
+                addUp = cryptor->copyPointer(negatedMessageMatrix[hfInd][binIndex][0], arena);
             }
             else
             {
-                addUp = encryptedMessageMatrix[hfInd][binIndex][0];
+                addUp = cryptor->copyPointer(encryptedMessageMatrix[hfInd][binIndex][0], arena);
             }
             bitVectorIndex++;
             for (uint i = 1; i < ct.cuckooTable[ct.getTableIndex(hfInd)][binIndex].size(); i++)
             {
                 if (xorVector[bitVectorIndex])
                 {
-                    addUp = cryptor.addPointer(addUp, negatedMessageMatrix[hfInd][binIndex][i]);
+                    cryptor->addInPlace(addUp, negatedMessageMatrix[hfInd][binIndex][i]);
                 }
                 else
                 {
-                    addUp = cryptor.addPointer(addUp, encryptedMessageMatrix[hfInd][binIndex][i]);
+                    cryptor->addInPlace(addUp, encryptedMessageMatrix[hfInd][binIndex][i]);
                 }
 
-                // Clean
-                // delete negatedMessageMatrix[hfInd][binIndex][i];
-                // delete encryptedMessageMatrix[hfInd][binIndex][i];
-
                 bitVectorIndex++;
             }
-            shuffledResultList[permutationVector[resultIndex]] = cryptor.randomizedEquality(minusCompareElement, addUp,
+            cryptor->normalize(addUp);
+            shuffledResultList[permutationVector[resultIndex]] = cryptor->randomizedEquality(minusCompareElement, addUp,
                                                                                             encryptedZeros[resultIndex].get());
             // important
             resultIndex++;
@@ -110,9 +136,194 @@ void PrecompElGamalPIE::run()
 
     for (uint stashInd = 0; stashInd < ct.stash.size(); stashInd++)
     {
-        shuffledResultList[permutationVector[resultIndex]] = cryptor.randomizedEquality(minusCompareElement, ct.stash[stashInd],
+        shuffledResultList[permutationVector[resultIndex]] = cryptor->randomizedEquality(minusCompareElement, ct.stash[stashInd],
                                                                                         encryptedZeros[resultIndex].get());
         // important
         resultIndex++;
     }
 }
+
+void PrecompElGamalPIE::precompNative()
+{
+    resolveNativeInputs(*cryptor, encryptedZeros, true);
+    NativeECGroup &group = *cryptor->getNativeGroup();
+    // The arena is not thread-safe, all entries are acquired before the parallel part
+    for (size_t i = 0; i < nativeIndexMatrix.size(); i++)
+    {
+        for (size_t k = 0; k < ct.getBinSize(); k++)
+        {
+            for (size_t j = 0; j < nativeIndexMatrix[i].size(); j++)
+            {
+                encryptedMessageMatrix[i][k][j] = arena->acquireNative(group);
+                negatedMessageMatrix[i][k][j] = arena->acquireNative(group);
+            }
+        }
+    }
+
+    intraSplit.forEach(nativeIndexMatrix.size() * ct.getBinSize(), *cryptor, [this](size_t bin, AddHomElGamalEnc &worker)
+                 {
+                     size_t i = bin / ct.getBinSize();
+                     size_t k = bin % ct.getBinSize();
+                     auto &items = ct.cuckooTable[ct.getTableIndex(i)][k];
+                     for (size_t j = 0; j < nativeIndexMatrix[i].size(); j++)
+                     {
+                         NativeElGamalCiphertext &encrypted = *static_cast<NativeElGamalCiphertext *>(encryptedMessageMatrix[i][k][j]);
+                         NativeElGamalCiphertext &negated = *static_cast<NativeElGamalCiphertext *>(negatedMessageMatrix[i][k][j]);
+                         worker.multByConst(encrypted, *nativeIndexMatrix[i][j], items[j]);
+                         worker.elementXorByConst(negated, encrypted, items[j]);
+                     } });
+}
+
+/**
+ * @brief Same as run, but with the typed operations of the native backend, a single accumulator and results written in place.
+ */
+void PrecompElGamalPIE::runNative()
+{
+    resolveNativeInputs(*cryptor, encryptedZeros, false);
+    if (cryptor->usesEncryptedZeroPool())
+    {
+        cryptor->drawEncryptedZeros(nativeZeros);
+    }
+    const NativeElGamalCiphertext &minusCompare = *nativeMinusCompareElement;
+    NativeElGamalCiphertext &addUp = *arena->acquireNative(*cryptor->getNativeGroup());
+
+    int resultIndex = 0;
+    int bitVectorIndex = 0;
+    for (uint hfInd = 0; hfInd < ct.getNumberOfHashFunctions(); hfInd++)
+    {
+        for (size_t binIndex = 0; binIndex < ct.cuckooTable[ct.getTableIndex(hfInd)].size(); binIndex++)
+        {
+            auto &negated = negatedMessageMatrix[hfInd][binIndex];
+            auto &encrypted = encryptedMessageMatrix[hfInd][binIndex];
+            cryptor->copy(addUp, nativeAt(xorVector[bitVectorIndex] ? negated[0] : encrypted[0]));
+            bitVectorIndex++;
+            for (uint i = 1; i < encrypted.size(); i++)
+            {
+                cryptor->addInPlace(addUp, nativeAt(xorVector[bitVectorIndex] ? negated[i] : encrypted[i]));
+                bitVectorIndex++;
+            }
+            cryptor->normalize(addUp);
+            cryptor->randomizedEquality(*nativeResults[resultIndex], minusCompare, addUp, *nativeZeros[resultIndex]);
+            resultIndex++;
+        }
+    }
+
+    for (uint stashInd = 0; stashInd < ct.stash.size(); stashInd++)
+    {
+        cryptor->randomizedEquality(*nativeResults[resultIndex], minusCompare, ct.stash[stashInd]);
+        resultIndex++;
+    }
+}
+
+void PrecompElGamalPIE::releasePrecomp()
+{
+    if (usesLean())
+    {
+        vector<unsigned char>().swap(encodedMessageMatrix);
+        precomputed = false;
+    }
+}
+
+/**
+ * @brief Encrypted message matrix only, normalized with one inversion per hash function and stored as octets.
+ */
+void PrecompElGamalPIE::precompLean()
+{
+    resolveNativeInputs(*cryptor, encryptedZeros, true);
+    NativeECGroup &group = *cryptor->getNativeGroup();
+    size_t binSize = ct.getBinSize();
+    size_t positions = ct.cuckooTable[0][0].size();
+    pointOctets = group.getPointOctets();
+    encodedMessageMatrix.assign(nativeIndexMatrix.size() * binSize * positions * 2 * pointOctets, 0);
+
+    // One subtask per bin of a hash function, normalized with one inversion per bin
+    intraSplit.forEach(nativeIndexMatrix.size() * binSize, *cryptor, [this, binSize](size_t bin, AddHomElGamalEnc &worker)
+                 {
+                     NativeECGroup &workerGroup = *worker.getNativeGroup();
+                     size_t i = bin / binSize;
+                     size_t k = bin % binSize;
+                     auto &table = ct.cuckooTable[ct.getTableIndex(i)];
+                     vector<NativeECPoint> u, v;
+                     vector<EC_POINT *> toNormalize;
+                     for (size_t j = 0; j < nativeIndexMatrix[i].size(); j++)
+                     {
+                         const NativeElGamalCiphertext &index = *nativeIndexMatrix[i][j];
+                         auto scalar = workerGroup.toScalar(table[k][j]);
+                         u.push_back(workerGroup.newPoint());
+                         v.push_back(workerGroup.newPoint());
+                         workerGroup.mul(u[j], index.u, scalar.get());
+                         workerGroup.mul(v[j], index.v, scalar.get());
+                         toNormalize.push_back(u[j].get());
+                         toNormalize.push_back(v[j].get());
+                     }
+                     workerGroup.normalize(toNormalize);
+                     for (size_t j = 0; j < nativeIndexMatrix[i].size(); j++)
+                     {
+                         unsigned char *encoded = encodedAt(i, k, j);
+                         workerGroup.toOctets(u[j], encoded);
+                         workerGroup.toOctets(v[j], encoded + pointOctets);
+                     } });
+}
+
+/**
+ * @brief Like runNative on the octet matrix. The negated entry (u^-1, g^item * v^-1) is derived on demand:
+ *        its u and v are subtracted from the sum and the g^item of all negated entries of a bin are added with a single multiplication.
+ */
+void PrecompElGamalPIE::runLean()
+{
+    resolveNativeInputs(*cryptor, encryptedZeros, false);
+    if (cryptor->usesEncryptedZeroPool())
+    {
+        cryptor->drawEncryptedZeros(nativeZeros);
+    }
+    const NativeElGamalCiphertext &minusCompare = *nativeMinusCompareElement;
+    NativeECGroup &group = *cryptor->getNativeGroup();
+    NativeElGamalCiphertext &addUp = *arena->acquireNative(group);
+    NativeElGamalCiphertext &entry = *arena->acquireNative(group);
+    NativeECPoint generatorPower = group.newPoint();
+
+    int resultIndex = 0;
+    int bitVectorIndex = 0;
+    for (uint hfInd = 0; hfInd < ct.getNumberOfHashFunctions(); hfInd++)
+    {
+        auto &table = ct.cuckooTable[ct.getTableIndex(hfInd)];
+        for (size_t binIndex = 0; binIndex < table.size(); binIndex++)
+        {
+            group.setToInfinity(addUp.u);
+            group.setToInfinity(addUp.v);
+            biginteger negatedItemSum = 0;
+            for (uint i = 0; i < table[binIndex].size(); i++)
+            {
+                const unsigned char *encoded = encodedAt(hfInd, binIndex, i);
+                group.fromOctets(entry.u, encoded);
+                group.fromOctets(entry.v, encoded + pointOctets);
+                if (xorVector[bitVectorIndex])
+                {
+                    group.subtract(addUp.u, addUp.u, entry.u);
+                    group.subtract(addUp.v, addUp.v, entry.v);
+                    negatedItemSum += table[binIndex][i];
+                }
+                else
+                {
+                    cryptor->addInPlace(addUp, entry);
+                }
+                bitVectorIndex++;
+            }
+            if (negatedItemSum != 0)
+            {
+                auto scalar = group.toScalar(negatedItemSum);
+                group.mulGenerator(generatorPower, scalar.get());
+                group.add(addUp.v, addUp.v, generatorPower);
+            }
+            cryptor->normalize(addUp);
+            cryptor->randomizedEquality(*nativeResults[resultIndex], minusCompare, addUp, *nativeZeros[resultIndex]);
+            resultIndex++;
+        }
+    }
+
+    for (uint stashInd = 0; stashInd < ct.stash.size(); stashInd++)
+    {
+        cryptor->randomizedEquality(*nativeResults[resultIndex], minusCompare, ct.stash[stashInd]);
+        resultIndex++;
+    }
+}
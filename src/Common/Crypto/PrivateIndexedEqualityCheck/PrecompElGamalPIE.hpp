@@ -8,23 +8,88 @@
 #pragma once
 #include "src/Common/Crypto/AddHomElGamalEnc.hpp"
 #include "HIPPIE.hpp"
+#include "IntraPIESplit.hpp"
 #include "boost/dynamic_bitset.hpp"
 
-class PrecompElGamalPIE : public HIPPIE
+class PrecompElGamalPIE final : public HIPPIE
 {
 
 private:
-    AddHomElGamalEnc &cryptor;
+    AddHomElGamalEnc *cryptor;
+    CiphertextArena *arena; // Owns the precomputed matrices and intermediate sums
+    // Native ciphertexts of the arena if the native backend is enabled, see nativeAt
     vector<vector<vector<AsymmetricCiphertext *>>> negatedMessageMatrix;
     vector<vector<vector<AsymmetricCiphertext *>>> encryptedMessageMatrix;
     boost::dynamic_bitset<unsigned char> xorVector;
     vector<shared_ptr<AsymmetricCiphertext>> encryptedZeros;
 
+    // Lean mode: only the encrypted message matrix, u and v of entry [hf][bin][pos] as octets, negated entries are derived in run
+    bool lean = false;
+    size_t pointOctets = 0;
+    vector<unsigned char> encodedMessageMatrix;
+    bool precomputed = false;
+    IntraPIESplit intraSplit;
+
+    /**
+     * @brief Typed access to the precomputed matrices, which precomp fills with native ciphertexts only if the native backend is enabled.
+     */
+    static const NativeElGamalCiphertext &nativeAt(AsymmetricCiphertext *precomputed)
+    {
+        return *static_cast<const NativeElGamalCiphertext *>(precomputed);
+    }
+
+    void precompNative();
+    void runNative();
+    void precompLean();
+    void runLean();
+
+    bool usesLean() { return lean && cryptor->usesNativeBackend(); }
+
+    unsigned char *encodedAt(size_t hfInd, size_t binIndex, size_t position)
+    {
+        return &encodedMessageMatrix[((hfInd * ct.getBinSize() + binIndex) * ct.cuckooTable[0][0].size() + position) * 2 * pointOctets];
+    }
+
 public:
-    PrecompElGamalPIE(AddHomElGamalEnc &cryptor, CuckooHashTable &ct);
+    PrecompElGamalPIE(AddHomElGamalEnc &cryptor, CiphertextArena &arena, CuckooHashTable &ct);
+
+    /**
+     * @brief Lets the next precomp or run use cryptor and arena, e.g., the ones of the pool worker that runs it.
+     *        Ciphertexts of an earlier precomputation stay in the arena they were created in.
+     */
+    void bind(AddHomElGamalEnc &cryptor, CiphertextArena &arena)
+    {
+        this->cryptor = &cryptor;
+        this->arena = &arena;
+    }
 
     void precomp();
 
+    /**
+     * @brief Memory-lean precomputation (native backend only, ignored otherwise): instead of the encrypted and the negated
+     *        ciphertext matrix of raw pointers, only the encrypted matrix is kept in uncompressed octets. Has to be set before precomp.
+     */
+    void setLean(bool lean) { this->lean = lean; }
+
+    /**
+     * @brief Splits every precomputation of the native backend across up to threads workers of pool
+     *        (WorkStealingPool::parallelFor), one subtask per bin and hash function, each with the cryptor of its worker.
+     */
+    void setIntraThreads(unsigned int threads, WorkStealingPool &pool, vector<AddHomElGamalEnc> &workerCryptors)
+    {
+        intraSplit.maxWorkers = std::max(1u, threads);
+        intraSplit.pool = &pool;
+        intraSplit.workerCryptors = &workerCryptors;
+    }
+
+    bool isPrecomputed() const { return precomputed; }
+
+    /**
+     * @brief Frees the precomputed matrix in lean mode, i.e., precomp has to be called again before the next run.
+     *        Precomputations of the other modes live in the arena and stay until the end of the session.
+     */
+    void releasePrecomp();
+
     void setBitVector(boost::dynamic_bitset<unsigned char> &&xorVector);
 
     void run() override;
@@ -0,0 +1,88 @@
+/**
+ * @file OrderedSender.cpp
+ *
+ * @version 0.1
+ *
+ */
+#include "OrderedSender.hpp"
+#include <stdexcept>
+#include <string>
+
+OrderedSender::OrderedSender(size_t numberOfJobs, SendFunction send)
+    : send(std::move(send)),
+      completed(numberOfJobs, false)
+{
+    sender = std::thread(&OrderedSender::senderLoop, this);
+}
+
+OrderedSender::~OrderedSender()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    jobCompleted.notify_all();
+    if (sender.joinable())
+    {
+        sender.join();
+    }
+}
+
+void OrderedSender::complete(size_t job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (job >= completed.size() || completed[job])
+        {
+            throw std::invalid_argument("Job " + std::to_string(job) + " does not exist or is already complete");
+        }
+        completed[job] = true;
+    }
+    jobCompleted.notify_all();
+}
+
+void OrderedSender::finish()
+{
+    if (sender.joinable())
+    {
+        sender.join();
+    }
+    if (error)
+    {
+        std::exception_ptr sendError = error;
+        error = nullptr;
+        std::rethrow_exception(sendError);
+    }
+}
+
+void OrderedSender::senderLoop()
+{
+    while (true)
+    {
+        size_t job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobCompleted.wait(lock, [this]
+                              { return stopped || nextJob == completed.size() || completed[nextJob]; });
+            if (stopped || nextJob == completed.size())
+            {
+                return;
+            }
+            job = nextJob;
+        }
+
+        try
+        {
+            send(job);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        nextJob++;
+    }
+}
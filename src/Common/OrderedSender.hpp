@@ -0,0 +1,64 @@
+/**
+ * @file OrderedSender.hpp
+ *
+ * @version 0.1
+ *
+ */
+#pragma once
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Sends the results of numbered jobs (PIEs, FHE bins) from its own thread in job order, as soon as a job
+ *        and all jobs before it are complete. Results leave while later jobs still run and the receiver gets them
+ *        in the same order as before, so the wire format does not change.
+ *
+ * Only the send function runs on the sender thread, it must not use state that the completing threads still change.
+ */
+class OrderedSender
+{
+public:
+    using SendFunction = std::function<void(size_t job)>;
+
+private:
+    SendFunction send;
+    std::vector<bool> completed; // [job]
+    size_t nextJob = 0;          // first job that was not sent yet
+    bool stopped = false;
+    std::exception_ptr error;
+
+    std::mutex mutex;
+    std::condition_variable jobCompleted;
+    std::thread sender;
+
+    void senderLoop();
+
+public:
+    /**
+     * @param numberOfJobs jobs 0 to numberOfJobs - 1, each has to be completed exactly once
+     * @param send sends the result of one job
+     */
+    OrderedSender(size_t numberOfJobs, SendFunction send);
+
+    /**
+     * @brief Stops without sending the remaining jobs if finish was not called, e.g., if a job failed.
+     */
+    ~OrderedSender();
+
+    OrderedSender(const OrderedSender &) = delete;
+    OrderedSender &operator=(const OrderedSender &) = delete;
+
+    /**
+     * @brief Marks job as complete, thread-safe. Its result must not change afterwards.
+     */
+    void complete(size_t job);
+
+    /**
+     * @brief Blocks until all jobs have been sent. Rethrows the exception of a failed send.
+     */
+    void finish();
+};
@@ -42,6 +42,11 @@ pair<bool, pair<PSIParameter,HashTableParameter>> readParameters(int argc, char
     uint64_t bitSize;
     bool bgv;
     bool batched;
+    bool nativeEC;
+    bool leanPrecomp;
+    size_t precompWindow;
+    size_t intraPIEThreads;
+    size_t numberOfStreams;
 
     // Declare the supported options.
     po::options_description desc("Allowed options");
@@ -68,9 +73,14 @@ pair<bool, pair<PSIParameter,HashTableParameter>> readParameters(int argc, char
         ("itemSeed", po::value<uint64_t>(&itemSeed)->default_value(123456789), "itemSeed")
         ("ip", po::value<std::string>(&ip)->default_value("127.0.0.1"),"ip adress")
         ("port", po::value<int>(&port)->default_value(8000), "ip port")
-        ("curve", po::value<string>(&curveName)->default_value("P-256"), "Curve for ElGamal based PSI, not used for FHE")
+        ("curve", po::value<string>(&curveName)->default_value("P-256"), "Curve for ElGamal based PSI (NIST name or ristretto255), not used for FHE. ristretto255 has shorter encodings, but OpenSSL only offers generic arithmetic for it, i.e., its scalar multiplications are several times slower than P-256")
         ("bgv", po::bool_switch(&bgv), "Use BGV instead of BFV, only used for FHE")
-        ("batched", po::bool_switch(&batched), "Use batched FHE version, only used for FHE");
+        ("batched", po::bool_switch(&batched), "Use batched FHE version, only used for FHE")
+        ("nativeEC", po::bool_switch(&nativeEC), "Use native OpenSSL EC arithmetic instead of libscapi group elements, only used for ElGamal, implied by ristretto255")
+        ("leanPrecomp", po::bool_switch(&leanPrecomp), "Keep only the encrypted precomputation matrix in compact form, only used for ElGamal with precomputation and native EC")
+        ("precompWindow", po::value<size_t>(&precompWindow)->default_value(0), "With leanPrecomp and nativeEC: PIEs per thread precomputed ahead, i.e., the first ones offline and PIE k + window * threads while PIE k runs, 0 precomputes all offline")
+        ("intraPIEThreads", po::value<size_t>(&intraPIEThreads)->default_value(1), "Workers of the nThreads pool each PIE run (or precomputation with precomp) is split across, i.e., no extra threads, only used for ElGamal with native EC")
+        ("streams", po::value<size_t>(&numberOfStreams)->default_value(1), "Parallel TCP connections the messages are striped over, must be equal for server and client");
         
     po::variables_map vm;
     po::store(parse_command_line(argc, argv, desc), vm);
@@ -100,12 +110,22 @@ pair<bool, pair<PSIParameter,HashTableParameter>> readParameters(int argc, char
                            bitSize,
                            curveName,
                            bgv,
-                           batched);
+                           batched,
+                           nativeEC || curveName == "ristretto255",
+                           leanPrecomp,
+                           precompWindow,
+                           intraPIEThreads,
+                           numberOfStreams);
 
     if (vm.count("help")) {
         cout << desc << "\n";
         return make_pair(false, make_pair(parsedParams, parsedHTParams));
     } 
 
+    if (precompWindow > 0 && !(leanPrecomp && parsedParams.nativeEC)) {
+        cout << "precompWindow requires leanPrecomp and nativeEC" << "\n";
+        return make_pair(false, make_pair(parsedParams, parsedHTParams));
+    }
+
     return make_pair(true, make_pair(parsedParams, parsedHTParams));
 }
\ No newline at end of file
@@ -23,6 +23,11 @@ struct PSIParameter
     const std::string curveName;
     const bool bgv;
     const bool batched;
+    const bool nativeEC;
+    const bool leanPrecomp;
+    const size_t precompWindow;
+    const size_t intraPIEThreads;
+    const size_t numberOfStreams;
 
     PSIParameter(size_t serverSetSize,
                  size_t clientSetSize,
@@ -39,7 +44,12 @@ struct PSIParameter
                  uint64_t bitSize,
                  std::string curveName,
                  bool bgv,
-                 bool batched) : serverSetSize(serverSetSize),
+                 bool batched,
+                 bool nativeEC,
+                 bool leanPrecomp,
+                 size_t precompWindow,
+                 size_t intraPIEThreads,
+                 size_t numberOfStreams) : serverSetSize(serverSetSize),
                                  clientSetSize(clientSetSize),
                                  intersectionSetSize(intersectionSetSize),
                                  hashSeed(hashSeed),
@@ -54,7 +64,12 @@ struct PSIParameter
                                  bitSize(bitSize),
                                  curveName(curveName),
                                  bgv(bgv),
-                                 batched(batched)
+                                 batched(batched),
+                                 nativeEC(nativeEC),
+                                 leanPrecomp(leanPrecomp),
+                                 precompWindow(precompWindow),
+                                 intraPIEThreads(intraPIEThreads),
+                                 numberOfStreams(numberOfStreams)
     {
     }
 };
\ No newline at end of file
@@ -0,0 +1,137 @@
+/**
+ * @file WireStreams.hpp
+ *
+ * @version 0.1
+ *
+ */
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Output buffer that serializes directly into a std::string, which is then moved to the channel.
+ *        ostringstream::str() would copy the whole serialization once more.
+ */
+class StringOutBuffer : public std::streambuf
+{
+private:
+    std::string data;
+    size_t committed = 0; // bytes before pbase()
+
+    void grow(size_t minimumSize)
+    {
+        size_t used = size();
+        data.resize(std::max(minimumSize, 2 * data.size()));
+        committed = used;
+        setp(&data[0] + used, &data[0] + data.size());
+    }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            return traits_type::not_eof(c);
+        }
+        grow(size() + 1);
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        if (epptr() - pptr() < n)
+        {
+            grow(size() + n);
+        }
+        std::memcpy(pptr(), s, n);
+        // Restart the put area behind the new bytes, pbump only takes an int
+        committed = size() + n;
+        setp(&data[0] + committed, &data[0] + data.size());
+        return n;
+    }
+
+public:
+    explicit StringOutBuffer(size_t initialSize = 4096) { grow(initialSize); }
+
+    size_t size() const { return committed + (pptr() - pbase()); }
+
+    /**
+     * @brief Returns the bytes written so far and starts over with an empty buffer.
+     */
+    std::string take()
+    {
+        data.resize(size());
+        std::string result;
+        result.swap(data);
+        committed = 0;
+        setp(nullptr, nullptr);
+        return result;
+    }
+};
+
+/**
+ * @brief Input buffer over a received message, i.e., deserialization reads the receive buffer in place.
+ *        The message must outlive the buffer.
+ */
+class FrameInBuffer : public std::streambuf
+{
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override
+    {
+        off_type base = direction == std::ios_base::beg ? 0 : direction == std::ios_base::cur ? gptr() - eback() : egptr() - eback();
+        return seekpos(base + offset, which);
+    }
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override
+    {
+        if (!(which & std::ios_base::in) || position < 0 || position > egptr() - eback())
+        {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + position, egptr());
+        return position;
+    }
+
+public:
+    FrameInBuffer(const unsigned char *frame, size_t size)
+    {
+        char *begin = const_cast<char *>(reinterpret_cast<const char *>(frame)); // get area is never written
+        setg(begin, begin, begin + size);
+    }
+
+    explicit FrameInBuffer(const std::vector<unsigned char> &frame) : FrameInBuffer(frame.data(), frame.size()) {}
+};
+
+/**
+ * @brief ostream over a StringOutBuffer, a drop-in for ostringstream whose result is taken instead of copied.
+ */
+class StringOutStream : public std::ostream
+{
+private:
+    StringOutBuffer buffer;
+
+public:
+    explicit StringOutStream(size_t initialSize = 4096) : std::ostream(nullptr), buffer(initialSize) { rdbuf(&buffer); }
+
+    size_t size() const { return buffer.size(); }
+    std::string take() { return buffer.take(); }
+};
+
+/**
+ * @brief istream over a received message, a drop-in for istringstream(string(frame.begin(), frame.end())) without both copies.
+ */
+class FrameInStream : public std::istream
+{
+private:
+    FrameInBuffer buffer;
+
+public:
+    explicit FrameInStream(const std::vector<unsigned char> &frame) : std::istream(nullptr), buffer(frame) { rdbuf(&buffer); }
+};
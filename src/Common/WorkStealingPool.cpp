@@ -0,0 +1,235 @@
+/**
+ * @file WorkStealingPool.cpp
+ *
+ * @version 0.1
+ *
+ */
+#include "WorkStealingPool.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+// Pool and index of the worker that runs on this thread
+thread_local const WorkStealingPool *currentPool = nullptr;
+thread_local size_t currentWorkerIndex = 0;
+}
+
+struct WorkStealingPool::ParallelFor
+{
+    const IndexTask *body; // only used while an index is left, i.e., while parallelFor waits
+    size_t n;
+    std::atomic<size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable allFinished;
+    size_t finished = 0;
+    std::exception_ptr firstError;
+};
+
+WorkStealingPool::WorkStealingPool(size_t numberOfWorkers)
+{
+    if (numberOfWorkers < 1)
+    {
+        throw std::invalid_argument("Number of threads need to be larger than 0");
+    }
+    for (size_t i = 0; i < numberOfWorkers; i++)
+    {
+        queues.emplace_back(new WorkerQueue());
+    }
+    for (size_t i = 0; i < numberOfWorkers; i++)
+    {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopped = true;
+    }
+    taskQueued.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    submit(nextQueue++ % queues.size(), std::move(task));
+}
+
+void WorkStealingPool::submit(size_t worker, Task task)
+{
+    // Counted before it is visible, a worker that takes it right away must not see queued drop below zero
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        queued++;
+        pending++;
+    }
+    {
+        WorkerQueue &queue = *queues[worker % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    taskQueued.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allDone.wait(lock, [this]
+                 { return pending == 0; });
+    if (firstError)
+    {
+        std::exception_ptr error = firstError;
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * @brief Newest task of the own queue, it was queued last and its inputs are most likely still in the cache.
+ */
+bool WorkStealingPool::pop(size_t worker, Task &task)
+{
+    WorkerQueue &queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+/**
+ * @brief Oldest task of the first non-empty queue after the own one.
+ */
+bool WorkStealingPool::steal(size_t worker, Task &task)
+{
+    for (size_t offset = 1; offset < queues.size(); offset++)
+    {
+        WorkerQueue &queue = *queues[(worker + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(size_t worker)
+{
+    currentPool = this;
+    currentWorkerIndex = worker;
+    Task task;
+    while (true)
+    {
+        if (!pop(worker, task) && !steal(worker, task))
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            if (stopped && queued == 0)
+            {
+                return;
+            }
+            // queued counts tasks that are pushed but not yet taken, so no wake-up is lost between the checks above and here
+            taskQueued.wait(lock, [this]
+                            { return stopped || queued > 0; });
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            queued--;
+        }
+        try
+        {
+            task(worker);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (!firstError)
+            {
+                firstError = std::current_exception();
+            }
+        }
+        task = nullptr;
+
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (--pending == 0)
+        {
+            allDone.notify_all();
+        }
+    }
+}
+
+size_t WorkStealingPool::currentWorker() const
+{
+    return currentPool == this ? currentWorkerIndex : size();
+}
+
+void WorkStealingPool::runIndices(ParallelFor &loop, size_t worker)
+{
+    size_t index;
+    while ((index = loop.next++) < loop.n)
+    {
+        std::exception_ptr error;
+        try
+        {
+            (*loop.body)(index, worker);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        if (error && !loop.firstError)
+        {
+            loop.firstError = error;
+        }
+        if (++loop.finished == loop.n)
+        {
+            loop.allFinished.notify_all();
+        }
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t n, size_t maxWorkers, const IndexTask &body)
+{
+    if (n == 0)
+    {
+        return;
+    }
+    auto loop = std::make_shared<ParallelFor>();
+    loop->body = &body;
+    loop->n = n;
+
+    // Helpers that start after all indices are taken return right away, they only keep the shared state alive
+    size_t worker = currentWorker();
+    bool callerHelps = worker < size();
+    size_t helpers = std::min(std::min(std::max<size_t>(maxWorkers, 1), size()), n) - (callerHelps ? 1 : 0);
+    for (size_t helper = 1; helper <= helpers; helper++)
+    {
+        submit(worker + helper, [loop](size_t helperWorker)
+               { runIndices(*loop, helperWorker); });
+    }
+    if (callerHelps)
+    {
+        runIndices(*loop, worker);
+    }
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->allFinished.wait(lock, [&loop]
+                           { return loop->finished == loop->n; });
+    if (loop->firstError)
+    {
+        std::rethrow_exception(loop->firstError);
+    }
+}
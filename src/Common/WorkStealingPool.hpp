@@ -0,0 +1,102 @@
+/**
+ * @file WorkStealingPool.hpp
+ *
+ * @version 0.1
+ *
+ */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of long-lived worker threads, each with its own task queue.
+ *
+ * A worker takes the newest task of its own queue and, once that is empty, steals the oldest task of another queue,
+ * so uneven tasks (or more tasks than workers in one queue) are balanced without any fixed assignment.
+ * Tasks get the index of the executing worker, i.e., per worker state (cryptors, arenas) can be indexed without locking.
+ *
+ * The servers create one pool per run and use it in all phases, instead of one thread per PIE collection and phase.
+ */
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void(size_t worker)>;
+    using IndexTask = std::function<void(size_t index, size_t worker)>;
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextQueue{0}; // round robin of submit without worker
+
+    std::mutex stateMutex;
+    std::condition_variable taskQueued;
+    std::condition_variable allDone;
+    size_t queued = 0;  // tasks in the queues
+    size_t pending = 0; // submitted tasks that did not finish yet
+    bool stopped = false;
+    std::exception_ptr firstError;
+
+    struct ParallelFor; // shared by the workers of one parallelFor
+
+    bool pop(size_t worker, Task &task);
+    bool steal(size_t worker, Task &task);
+    void workerLoop(size_t worker);
+    static void runIndices(ParallelFor &loop, size_t worker);
+
+public:
+    /**
+     * @param numberOfWorkers number of threads, at least one
+     */
+    explicit WorkStealingPool(size_t numberOfWorkers);
+
+    /**
+     * @brief Runs the remaining tasks and joins all workers.
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /**
+     * @brief Queues task at the workers in round robin.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Queues task at worker, which runs it unless another worker runs out of tasks first and steals it.
+     */
+    void submit(size_t worker, Task task);
+
+    /**
+     * @brief Blocks until all submitted tasks have finished. Rethrows the first exception thrown by a task since the last wait.
+     */
+    void wait();
+
+    /**
+     * @brief Runs body(index, worker) for every index in [0, n) on up to maxWorkers workers, returns once all are done and
+     *        rethrows the first exception of body. Meant to split one task: called from a task, its worker takes indices
+     *        itself and maxWorkers - 1 helper tasks let other workers join as soon as they are free. No thread is created
+     *        and a waiting worker runs no other task, so body may use the per worker state of the worker it gets.
+     */
+    void parallelFor(size_t n, size_t maxWorkers, const IndexTask &body);
+
+    /**
+     * @brief Index of the worker of this pool that calls, size() if called from another thread.
+     */
+    size_t currentWorker() const;
+
+    size_t size() const { return workers.size(); }
+};
@@ -9,6 +9,7 @@
 #include "src/Common/Hashing/HierarchicalCuckooHashTable.hpp"
 #include "src/Common/Crypto/PrivateIndexedEqualityCheck/PIECollection.hpp"
 #include "src/Common/Parameter/HashTableParameter.hpp"
+#include "src/Common/OrderedSender.hpp"
 
 class ElGamalPSIServer : public PSIServer
 {
@@ -19,9 +20,9 @@ protected:
     shared_ptr<DlogGroup> dlog;
     AddHomElGamalEnc encryptor;
     TabulationHashing hashfunction;
-    vector<boost::thread *> threadsPIE;
     size_t nPiesToHandle;
-    size_t piesPerCollection;
+    shared_ptr<GeneratorPowerCache> generatorPowers; // g^item of the server items, shared by all PIE collections
+    shared_ptr<EncryptedZeroPool> encryptedZeroPool; // re-randomization zeros of the native backend, shared by all PIE collections
 
     ElGamalPSIServer(DataInputHandler &dataIH, PSIParameter &serverParams,
                      HashTableParameter &htParams, std::string protocolName) : PSIServer(dataIH, serverParams, protocolName + "ElGamal-" + serverParams.curveName),
@@ -45,17 +46,112 @@ protected:
         }
     }
 
+    bool usesRistretto() const
+    {
+        return serverParams.curveName == RISTRETTO255_CURVE_NAME;
+    }
+
+    /**
+     * @brief Creates a cryptor without key for one thread. ristretto255 has no libscapi group and always uses the native backend.
+     *        Native cryptors share the curve (NativeECCurve) and the libscapi group, which they only use for the key exchange,
+     *        so their creation does not depend on the number of threads. libscapi cryptors need their own (not thread-safe) group,
+     *        and a native group to validate received ciphertexts. libscapi cannot copy a loaded group, so newWorkerCryptors
+     *        lets every worker load its group itself. Thread-safe once setUpElGamalPSI has set dlog.
+     */
+    AddHomElGamalEnc newCryptor()
+    {
+        if (usesRistretto())
+        {
+            AddHomElGamalEnc cryptor;
+            cryptor.enableNativeBackend(serverParams.curveName);
+            return cryptor;
+        }
+        if (serverParams.nativeEC)
+        {
+            if (dlog == nullptr)
+            {
+                dlog = createDlogGroup();
+            }
+            AddHomElGamalEnc cryptor(dlog);
+            cryptor.enableNativeBackend(serverParams.curveName);
+            return cryptor;
+        }
+        // The own native group only replaces isMember of the received ciphertexts, see checkMembershipBatch
+        AddHomElGamalEnc cryptor(createDlogGroup());
+        cryptor.enableNativeValidation(serverParams.curveName);
+        return cryptor;
+    }
+
+    /**
+     * @brief Sets the client public key received by setUpElGamalPSI and the pool of zeros under that key for another cryptor.
+     * @param encodedNativeKey ristretto255 only: encryptor.getEncodedNativePublicKey(), which uses the group of encryptor
+     */
+    void setClientKey(AddHomElGamalEnc &cryptor, const string &encodedNativeKey)
+    {
+        if (usesRistretto())
+        {
+            cryptor.setNativePublicKey(encodedNativeKey);
+        }
+        else
+        {
+            cryptor.setKey(encryptor.getPublicKey());
+        }
+        cryptor.setEncryptedZeroPool(encryptedZeroPool);
+    }
+
+    /**
+     * @brief One cryptor with the client key per worker of the pool. The workers create them in parallel, i.e., the libscapi
+     *        curves are loaded at the same time and the setup takes one load however many threads there are.
+     */
+    vector<AddHomElGamalEnc> newWorkerCryptors()
+    {
+        vector<AddHomElGamalEnc> cryptors(pool->size());
+        string encodedNativeKey = usesRistretto() ? encryptor.getEncodedNativePublicKey() : "";
+        for (size_t index = 0; index < cryptors.size(); index++)
+        {
+            pool->submit([this, &cryptors, &encodedNativeKey, index](size_t)
+                         {
+                             cryptors[index] = newCryptor();
+                             setClientKey(cryptors[index], encodedNativeKey); });
+        }
+        pool->wait();
+        return cryptors;
+    }
+
+    /**
+     * @brief Native backend only: creates the pool of re-randomization zeros for the PIE results of one session
+     *        and starts its background refill, so neither PIE construction nor the sessions encrypt zeros.
+     */
+    void startEncryptedZeroPool()
+    {
+        if (!encryptor.usesNativeBackend())
+        {
+            return;
+        }
+        size_t zerosPerPIE = htParams.maxItemsPerPosition * htParams.numberOfCuckooHashFunctions + htParams.serverStashSize;
+        encryptedZeroPool = encryptor.newEncryptedZeroPool(nPiesToHandle * zerosPerPIE);
+        encryptedZeroPool->startBackgroundRefill();
+    }
+
+    /**
+     * @brief Tops the pool up in parallel (end of the offline phase), so the first session does not wait for the background thread.
+     */
+    void fillEncryptedZeroPool()
+    {
+        if (encryptedZeroPool)
+        {
+            encryptedZeroPool->fill();
+        }
+    }
+
     void setUpElGamalPSI()
     {
-        dlog = createDlogGroup();
-        encryptor = AddHomElGamalEnc(dlog);
+        encryptor = newCryptor();
+        dlog = encryptor.getDlog();
         uint64_t neededHfs = htParams.numberOfSimpleHashFunctions + htParams.numberOfCuckooHashFunctions;
         hashfunction = TabulationHashing(serverParams.hashSeed, neededHfs);
 
-        if (serverParams.numberOfThreads < 1)
-        {
-            throw invalid_argument("Number of threads need to be larger than 0");
-        }
+        startPool();
 #ifdef VERBOSE
         cout << "Receive public key from client" << endl;
 #endif
@@ -67,22 +163,29 @@ protected:
                                                                    htParams.numberOfCuckooHashFunctions, htParams.simpleMultiTable,
                                                                    htParams.cuckooMultiTable, htParams.maxItemsPerPosition);
 
-        threadsPIE = vector<boost::thread *>(serverParams.numberOfThreads);
-
         nPiesToHandle = serverHashTable->getNumberOfSimpleTables() * serverHashTable->getEachSimpleTableSize();
 
-        if (nPiesToHandle % serverParams.numberOfThreads != 0)
-        {
-            throw invalid_argument("Error: Number of Threads does not divide number of PIEs");
-        }
+        startEncryptedZeroPool();
+    }
 
-        piesPerCollection = nPiesToHandle / serverParams.numberOfThreads;
+    /**
+     * @brief Computes g^item for all given server items once (in parallel), the PIE collections then share the cache.
+     */
+    void buildGeneratorPowerCache(const vector<biginteger> &items)
+    {
+        generatorPowers = make_shared<GeneratorPowerCache>(serverParams.curveName);
+        generatorPowers->build(items);
     }
 
     void receiveAndSetPublicKey()
     {
         vector<unsigned char> pkVector;
         channel->readWithSizeIntoVector(pkVector);
+        if (usesRistretto())
+        {
+            encryptor.setNativePublicKey(string(pkVector.begin(), pkVector.end()));
+            return;
+        }
         shared_ptr<GroupElementSendableData> dummy = dlog.get()->getGenerator().get()->generateSendableData();
         ElGamalPublicKeySendableData pkS(dummy);
         pkS.initFromByteVector(pkVector);
@@ -90,19 +193,58 @@ protected:
         encryptor.setKey(pkP);
     }
 
-    AsymmetricCiphertext *receiveMinusCompareElement()
+    size_t indexMatrixFrames() const
+    {
+        return htParams.numberOfCuckooHashFunctions * htParams.eachCuckooTableSize;
+    }
+
+    /**
+     * @brief Decodes a received ciphertext with the cryptor of a worker, the arena of the worker takes ownership.
+     *        Only the curve equation is checked here, the subgroup membership of the received ciphertexts is checked
+     *        batch-wise per PIE by the task that runs it.
+     */
+    AsymmetricCiphertext *decodeCiphertext(vector<unsigned char> &frame, AddHomElGamalEnc &cryptor, CiphertextArena &arena)
     {
-        vector<unsigned char> cipherVector;
-        channel->readWithSizeIntoVector(cipherVector);
-        return encryptor.reconstructCiphertextPointer(cipherVector, false);
+        return cryptor.reconstructCiphertextPointer(frame, false, &arena);
     }
 
-    void sendResult(vector<shared_ptr<AsymmetricCiphertext>> &resultVector)
+    /**
+     * @brief Decodes the first indexMatrixFrames() frames as index matrix, see decodeCiphertext.
+     */
+    vector<vector<AsymmetricCiphertext *>> decodeIndexMatrix(vector<vector<unsigned char>> &frames, AddHomElGamalEnc &cryptor, CiphertextArena &arena)
     {
-        for (size_t i = 0; i < resultVector.size(); i++)
+        vector<vector<AsymmetricCiphertext *>> indexMatrix(htParams.numberOfCuckooHashFunctions,
+                                                           vector<AsymmetricCiphertext *>(htParams.eachCuckooTableSize));
+        for (uint outerIndex = 0; outerIndex < htParams.numberOfCuckooHashFunctions; outerIndex++)
         {
-            string cipherTextString = resultVector[i]->generateSendableData()->toString();
-            channel->writeWithSize(cipherTextString);
+            for (size_t index = 0; index < htParams.eachCuckooTableSize; index++)
+            {
+                indexMatrix[outerIndex][index] = decodeCiphertext(frames[outerIndex * htParams.eachCuckooTableSize + index], cryptor, arena);
+            }
         }
+        return indexMatrix;
+    }
+
+    /**
+     * @brief Queues the encoded results of one PIE as one batch, they are moved out of encodedResults.
+     */
+    void sendResult(vector<string> &encodedResults)
+    {
+        channel->writeBatch(std::move(encodedResults));
+    }
+
+    /**
+     * @brief Sender of one online phase: sends the encoded results of the PIEs of collection in PIE order, each as soon as
+     *        the PIE and all PIEs before it are complete. Stops sending once a PIE got invalid inputs, the phase then throws.
+     */
+    template <typename Collection>
+    shared_ptr<OrderedSender> newResultSender(shared_ptr<Collection> collection)
+    {
+        return make_shared<OrderedSender>(nPiesToHandle, [this, collection](size_t pieNumber)
+                                          {
+                                              if (collection->inputsValid)
+                                              {
+                                                  sendResult(collection->encodedResults[pieNumber]);
+                                              } });
     }
 };
\ No newline at end of file
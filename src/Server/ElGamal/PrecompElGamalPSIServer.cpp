@@ -16,44 +16,33 @@ void PrecompElGamalPSIServer::runSetUpPhase()
 {
     setUpElGamalPSI();
 
-    // Build empty PIEs
-    equalityTests = std::vector<std::shared_ptr<PrecompElGamalPIECollection>>(serverParams.numberOfThreads);
-    for (size_t i = 0; i < serverParams.numberOfThreads; i++)
-    {
-        auto encNew = AddHomElGamalEnc(createDlogGroup());
-        encNew.setKey(encryptor.getPublicKey());
-        equalityTests[i] = make_shared<PrecompElGamalPIECollection>(std::move(encNew));
-    }
+    // Build empty PIEs, each as soon as its random index matrix has been received
+    equalityTests = make_shared<PrecompElGamalPIECollection>(newWorkerCryptors(), nPiesToHandle);
+    equalityTests->leanPrecomp = serverParams.leanPrecomp;
+    // Only lean PIEs (native backend) are cheap to precompute online and release their precomputation afterwards
+    bool lean = serverParams.leanPrecomp && encryptor.usesNativeBackend();
+    equalityTests->precompWindow = lean ? serverParams.precompWindow : 0;
+    equalityTests->intraPIEThreads = serverParams.intraPIEThreads;
+    equalityTests->pool = pool.get();
 
     for (uint i = 0; i < serverHashTable->getNumberOfSimpleTables(); i++)
     {
         for (uint j = 0; j < serverHashTable->getEachSimpleTableSize(); j++)
         {
-            uint collectionIndex = (i * serverHashTable->getEachSimpleTableSize() + j) / piesPerCollection;
-
-            auto indexMatrix = receiveRandomIndexMatrix();
-            equalityTests[collectionIndex]->addPIE(serverHashTable->hierarchicalCuckooTable[i][j], std::move(indexMatrix));
+            size_t pieNumber = i * serverHashTable->getEachSimpleTableSize() + j;
+            CuckooHashTable *ct = &serverHashTable->hierarchicalCuckooTable[i][j];
+
+            // Random index matrix, decoded by the task
+            shared_ptr<vector<vector<unsigned char>>> frames = readFrames(indexMatrixFrames());
+            pool->submit([this, pieNumber, ct, frames](size_t worker)
+                         {
+                             vector<vector<AsymmetricCiphertext *>> indexMatrix = decodeIndexMatrix(*frames, equalityTests->cryptors[worker],
+                                                                                                   *equalityTests->arenas[worker]);
+                             channel->recycle(*frames);
+                             equalityTests->addPIE(pieNumber, *ct, std::move(indexMatrix), worker); });
         }
     }
-
-    precompThreadsPIE = vector<boost::thread *>(serverParams.numberOfThreads);
-}
-
-void precompTask(std::shared_ptr<PrecompElGamalPIECollection> &pieCollection)
-{
-
-    pieCollection->precompAll();
-
-    // Clear index vectors after use
-    //  delete compareElement;
-    //  for(auto v1 : indexMatrix) {
-    //      for(auto cEl : v1) {
-    //          delete cEl;
-    //      }
-
-    //     v1.clear();
-    // }
-    // indexMatrix.clear();
+    pool->wait();
 }
 
 void PrecompElGamalPSIServer::runOfflinePhase()
@@ -62,112 +51,74 @@ void PrecompElGamalPSIServer::runOfflinePhase()
     // Insert Elements into Cuckoo table
     serverHashTable->insertAll(serverSet);
 
-    for (uint i = 0; i < serverHashTable->getNumberOfSimpleTables(); i++)
+    // g^item is needed for every table entry in precomp
+    buildGeneratorPowerCache(serverSet);
+    for (auto &cryptor : equalityTests->cryptors)
     {
-
-        for (uint j = 0; j < serverHashTable->getEachSimpleTableSize(); j++)
-        {
-            uint collectionIndex = (i * serverHashTable->getEachSimpleTableSize() + j) / piesPerCollection;
-            uint pieNumber = (i * serverHashTable->getEachSimpleTableSize() + j);
-            uint pieNumberInsideCollection = pieNumber % piesPerCollection;
-
-            if (pieNumberInsideCollection == piesPerCollection - 1 || pieNumber == nPiesToHandle - 1)
-            {
-                // Start PIE thread
-                auto &pieCollToRun = equalityTests[collectionIndex];
-                precompThreadsPIE[collectionIndex] = new boost::thread(precompTask, pieCollToRun);
-            }
-        }
+        cryptor.setGeneratorPowerCache(generatorPowers);
     }
 
-    for (size_t collectionIndex = 0; collectionIndex < serverParams.numberOfThreads; collectionIndex++)
+    for (size_t pieNumber = 0; pieNumber < nPiesToHandle; pieNumber++)
     {
-        precompThreadsPIE[collectionIndex]->join();
+        pool->submit([this, pieNumber](size_t worker)
+                     { equalityTests->precompPIE(pieNumber, worker); });
+    }
+    pool->wait();
+    if (!equalityTests->inputsValid)
+    {
+        throw invalid_argument("Error, received random index matrix is not in the group");
     }
-}
-
-void threadTask(std::shared_ptr<PrecompElGamalPIECollection> &pieCollection)
-{
-
-    pieCollection->runAll();
-
-    // Clear index vectors after use
-    //  delete compareElement;
-    //  for(auto v1 : indexMatrix) {
-    //      for(auto cEl : v1) {
-    //          delete cEl;
-    //      }
 
-    //     v1.clear();
-    // }
-    // indexMatrix.clear();
+    fillEncryptedZeroPool();
 }
 
 void PrecompElGamalPSIServer::runOnlinePhase()
 {
+    // Results leave as the PIEs complete, while later ones are still received and run
+    shared_ptr<OrderedSender> resultSender = newResultSender(equalityTests);
 
     for (uint i = 0; i < serverHashTable->getNumberOfSimpleTables(); i++)
     {
 
         for (uint j = 0; j < serverHashTable->getEachSimpleTableSize(); j++)
         {
-            uint pieNumber = (i * serverHashTable->getEachSimpleTableSize() + j);
-            uint collectionIndex = pieNumber / piesPerCollection;
-            uint pieNumberInsideCollection = pieNumber % piesPerCollection;
-
-            // cout << "plain mbitset" << endl;
-            boost::dynamic_bitset<byte> mbitset = receivePlainBitvector();
-
-            // cout << "Receive compare element" << endl;
-            AsymmetricCiphertext *compareElement = receiveMinusCompareElement();
-
-            PrecompElGamalPIE &currentPIE = equalityTests[collectionIndex]->myPIEs[pieNumberInsideCollection];
-            // cout << "Run PIE" << endl;
-            currentPIE.setMinusCompareElement(compareElement);
-            currentPIE.setBitVector(std::move(mbitset));
-
-            if (pieNumberInsideCollection == piesPerCollection - 1 || pieNumber == nPiesToHandle - 1)
-            {
-                // Start PIE thread
-                auto &pieCollToRun = equalityTests[collectionIndex];
-                threadsPIE[collectionIndex] = new boost::thread(threadTask, pieCollToRun);
-            }
-        }
-    }
-
-    for (size_t collectionIndex = 0; collectionIndex < serverParams.numberOfThreads; collectionIndex++)
-    {
-
-        threadsPIE[collectionIndex]->join();
-        for (PrecompElGamalPIE &pie : equalityTests[collectionIndex]->myPIEs)
-        {
-            sendResult(pie.getResultList());
+            size_t pieNumber = i * serverHashTable->getEachSimpleTableSize() + j;
+
+            // Plain bitvector and compare element, decoded by the task
+            shared_ptr<vector<vector<unsigned char>>> frames = readFrames(2);
+
+            // Runs while the inputs of the next PIEs are received, and with a precomputation window, while PIE
+            // pieNumber + precompAhead() is precomputed by another task
+            pool->submit([this, pieNumber, frames, resultSender](size_t worker)
+                         {
+                             size_t ahead = pieNumber + equalityTests->precompAhead();
+                             if (equalityTests->precompWindow > 0 && ahead < nPiesToHandle)
+                             {
+                                 pool->submit([this, ahead](size_t aheadWorker)
+                                              { equalityTests->precompAheadPIE(ahead, aheadWorker); });
+                             }
+                             decodeAndRunPIE(pieNumber, *frames, worker);
+                             resultSender->complete(pieNumber); });
         }
-        delete threadsPIE[collectionIndex];
     }
-}
 
-vector<vector<AsymmetricCiphertext *>> PrecompElGamalPSIServer::receiveRandomIndexMatrix()
-{
-    vector<vector<AsymmetricCiphertext *>> indexMatrix = vector<vector<AsymmetricCiphertext *>>(htParams.numberOfCuckooHashFunctions,
-                                                                                                vector<AsymmetricCiphertext *>(htParams.eachCuckooTableSize));
-    for (uint outerIndex = 0; outerIndex < htParams.numberOfCuckooHashFunctions; outerIndex++)
+    pool->wait();
+    resultSender->finish();
+    if (!equalityTests->inputsValid)
     {
-        for (uint64_t index = 0; index < htParams.eachCuckooTableSize; index++)
-        {
-            vector<unsigned char> cipherVector;
-            channel->readWithSizeIntoVector(cipherVector);
-            auto cipherText = encryptor.reconstructCiphertextPointer(cipherVector, false);
-            indexMatrix[outerIndex][index] = cipherText;
-        }
+        throw invalid_argument("Error, received ciphertexts are not in the group");
     }
-    return indexMatrix;
+    equalityTests->endSession();
 }
 
-boost::dynamic_bitset<byte> PrecompElGamalPSIServer::receivePlainBitvector()
+void PrecompElGamalPSIServer::decodeAndRunPIE(size_t pieNumber, vector<vector<unsigned char>> &frames, size_t worker)
 {
-    vector<unsigned char> cipherVector;
-    channel->readWithSizeIntoVector(cipherVector);
-    boost::dynamic_bitset<byte> mbitset(cipherVector.begin(), cipherVector.end());
-    return mbitset;
+    boost::dynamic_bitset<byte> mbitset(frames[0].begin(), frames[0].end());
+    AsymmetricCiphertext *compareElement = decodeCiphertext(frames[1], equalityTests->cryptors[worker], *equalityTests->arenas[worker]);
+    channel->recycle(frames);
+
+    PrecompElGamalPIE &currentPIE = *equalityTests->myPIEs[pieNumber];
+    currentPIE.setMinusCompareElement(compareElement);
+    currentPIE.setBitVector(std::move(mbitset));
+    equalityTests->runPIE(pieNumber, worker);
 }
@@ -12,11 +12,12 @@ class PrecompElGamalPSIServer : public ElGamalPSIServer
 
 private:
     vector<vector<AsymmetricCiphertext *>> randomIndexMatrix;
-    vector<std::shared_ptr<PrecompElGamalPIECollection>> equalityTests;
-    vector<boost::thread *> precompThreadsPIE;
+    std::shared_ptr<PrecompElGamalPIECollection> equalityTests;
 
-    vector<vector<AsymmetricCiphertext *>> receiveRandomIndexMatrix();
-    boost::dynamic_bitset<byte> receivePlainBitvector();
+    /**
+     * @brief Online task of one PIE: decodes its received frames (plain bitvector, compare element) and runs it.
+     */
+    void decodeAndRunPIE(size_t pieNumber, vector<vector<unsigned char>> &frames, size_t worker);
 
     inline std::string protocolName()
     {
@@ -16,14 +16,10 @@ void SimpleElGamalPSIServer::runSetUpPhase()
 {
     setUpElGamalPSI();
 
-    // Build PIEs
-    equalityTests = std::vector<std::shared_ptr<ElGamalPIECollection>>(serverParams.numberOfThreads);
-    for (size_t i = 0; i < serverParams.numberOfThreads; i++)
-    {
-        auto encNew = AddHomElGamalEnc(createDlogGroup());
-        encNew.setKey(encryptor.getPublicKey());
-        equalityTests[i] = make_shared<ElGamalPIECollection>(std::move(encNew));
-    }
+    // PIEs are built in the offline phase, after the server items have been inserted
+    equalityTests = make_shared<ElGamalPIECollection>(newWorkerCryptors(), nPiesToHandle);
+    equalityTests->intraPIEThreads = serverParams.intraPIEThreads;
+    equalityTests->pool = pool.get();
 }
 
 void SimpleElGamalPSIServer::runOfflinePhase()
@@ -31,90 +27,77 @@ void SimpleElGamalPSIServer::runOfflinePhase()
     // Insert Elements into Cuckoo table
     serverHashTable->insertAll(serverSet);
 
+    // Only the stash items are compared via g^item
+    vector<biginteger> stashItems;
+    for (auto &simpleTable : serverHashTable->hierarchicalCuckooTable)
+    {
+        for (auto &cuckooTable : simpleTable)
+        {
+            stashItems.insert(stashItems.end(), cuckooTable.stash.begin(), cuckooTable.stash.end());
+        }
+    }
+    buildGeneratorPowerCache(stashItems);
+    for (auto &cryptor : equalityTests->cryptors)
+    {
+        cryptor.setGeneratorPowerCache(generatorPowers);
+    }
+
     for (uint i = 0; i < serverHashTable->getNumberOfSimpleTables(); i++)
     {
 
         for (uint j = 0; j < serverHashTable->getEachSimpleTableSize(); j++)
         {
-            uint collectionIndex = (i * serverHashTable->getEachSimpleTableSize() + j) / piesPerCollection;
-
-            equalityTests[collectionIndex]->addPIE(serverHashTable->hierarchicalCuckooTable[i][j]);
+            size_t pieNumber = i * serverHashTable->getEachSimpleTableSize() + j;
+            CuckooHashTable *ct = &serverHashTable->hierarchicalCuckooTable[i][j];
+            pool->submit([this, pieNumber, ct](size_t worker)
+                         { equalityTests->addPIE(pieNumber, *ct, worker); });
         }
     }
-}
-
-void threadTask(std::shared_ptr<ElGamalPIECollection> &pieCollection)
-{
-
-    pieCollection->runAll();
-
-    // Clear index vectors after use
-    //  delete compareElement;
-    //  for(auto v1 : indexMatrix) {
-    //      for(auto cEl : v1) {
-    //          delete cEl;
-    //      }
+    pool->wait();
 
-    //     v1.clear();
-    // }
-    // indexMatrix.clear();
+    fillEncryptedZeroPool();
 }
 
 void SimpleElGamalPSIServer::runOnlinePhase()
 {
+    // Results leave as the PIEs complete, while later ones are still received and run
+    shared_ptr<OrderedSender> resultSender = newResultSender(equalityTests);
 
     for (uint i = 0; i < serverHashTable->getNumberOfSimpleTables(); i++)
     {
 
         for (uint j = 0; j < serverHashTable->getEachSimpleTableSize(); j++)
         {
-            uint pieNumber = (i * serverHashTable->getEachSimpleTableSize() + j);
-            uint collectionIndex = pieNumber / piesPerCollection;
-            uint pieNumberInsideCollection = pieNumber % piesPerCollection;
-
-            // cout << "Receive index matrix" << endl;
-            vector<vector<AsymmetricCiphertext *>> indexMatrix = receiveIndexMatrix();
-
-            // cout << "Receive compare element" << endl;
-            AsymmetricCiphertext *minusCompareElement = receiveMinusCompareElement();
-
-            ElGamalPIE &currentPIE = equalityTests[collectionIndex]->myPIEs[pieNumberInsideCollection];
-            // cout << "Run PIE" << endl;
-            currentPIE.setIndexAndMinusCompareElement(std::move(indexMatrix), minusCompareElement);
-
-            if (pieNumberInsideCollection == piesPerCollection - 1 || pieNumber == nPiesToHandle - 1)
-            {
-                // Start PIE thread
-                auto &pieCollToRun = equalityTests[collectionIndex];
-                threadsPIE[collectionIndex] = new boost::thread(threadTask, pieCollToRun);
-            }
+            size_t pieNumber = i * serverHashTable->getEachSimpleTableSize() + j;
+
+            // Index matrix and compare element, decoded by the task
+            shared_ptr<vector<vector<unsigned char>>> frames = readFrames(indexMatrixFrames() + 1);
+
+            // Runs while the inputs of the next PIEs are received
+            pool->submit([this, pieNumber, frames, resultSender](size_t worker)
+                         {
+                             decodeAndRunPIE(pieNumber, *frames, worker);
+                             resultSender->complete(pieNumber); });
         }
     }
 
-    for (size_t collectionIndex = 0; collectionIndex < threadsPIE.size(); collectionIndex++)
+    pool->wait();
+    resultSender->finish();
+    if (!equalityTests->inputsValid)
     {
-        threadsPIE[collectionIndex]->join();
-        for (ElGamalPIE &pie : equalityTests[collectionIndex]->myPIEs)
-        {
-            sendResult(pie.getResultList());
-        }
-        delete threadsPIE[collectionIndex];
+        throw invalid_argument("Error, received ciphertexts are not in the group");
     }
+    equalityTests->endSession();
 }
 
-vector<vector<AsymmetricCiphertext *>> SimpleElGamalPSIServer::receiveIndexMatrix()
+void SimpleElGamalPSIServer::decodeAndRunPIE(size_t pieNumber, vector<vector<unsigned char>> &frames, size_t worker)
 {
-    vector<vector<AsymmetricCiphertext *>> indexMatrix = vector<vector<AsymmetricCiphertext *>>(htParams.numberOfCuckooHashFunctions,
-                                                                                                vector<AsymmetricCiphertext *>(htParams.eachCuckooTableSize));
-    for (uint outerIndex = 0; outerIndex < htParams.numberOfCuckooHashFunctions; outerIndex++)
-    {
-        for (size_t index = 0; index < htParams.eachCuckooTableSize; index++)
-        {
-            vector<unsigned char> cipherVector;
-            channel->readWithSizeIntoVector(cipherVector);
-            auto cipherText = encryptor.reconstructCiphertextPointer(cipherVector, false);
-            indexMatrix[outerIndex][index] = cipherText;
-        }
-    }
-    return indexMatrix;
-}
+    AddHomElGamalEnc &cryptor = equalityTests->cryptors[worker];
+    CiphertextArena &arena = *equalityTests->arenas[worker];
+    vector<vector<AsymmetricCiphertext *>> indexMatrix = decodeIndexMatrix(frames, cryptor, arena);
+    AsymmetricCiphertext *minusCompareElement = decodeCiphertext(frames.back(), cryptor, arena);
+    channel->recycle(frames);
+
+    equalityTests->myPIEs[pieNumber]->setIndexAndMinusCompareElement(std::move(indexMatrix), minusCompareElement);
+    equalityTests->runPIE(pieNumber, worker);
+}
\ No newline at end of file
@@ -11,9 +11,12 @@ class SimpleElGamalPSIServer : public ElGamalPSIServer
 {
 
 private:
-    vector<std::shared_ptr<ElGamalPIECollection>> equalityTests;
+    std::shared_ptr<ElGamalPIECollection> equalityTests;
 
-    vector<vector<AsymmetricCiphertext *>> receiveIndexMatrix();
+    /**
+     * @brief Online task of one PIE: decodes its received frames (index matrix, compare element) and runs it.
+     */
+    void decodeAndRunPIE(size_t pieNumber, vector<vector<unsigned char>> &frames, size_t worker);
 
     inline std::string protocolName()
     {
@@ -6,6 +6,7 @@
  */
 #include "BatchedFHEPSIServer.hpp"
 #include "src/Common/DataInput/RandomDataInput.hpp"
+#include "src/Common/WireStreams.hpp"
 #include "ciphertext-ser.h"
 #include "cryptocontext-ser.h"
 #include "key/key-ser.h"
@@ -24,7 +25,7 @@ void BatchedFHEPSIServer::receiveAndSetContextAndKeys()
     // Dererialize crypto context
     vector<unsigned char> contextVector;
     channel->readWithSizeIntoVector(contextVector);
-    auto contextStream = std::istringstream(std::string(contextVector.begin(), contextVector.end()));
+    FrameInStream contextStream(contextVector);
     lbcrypto::Serial::Deserialize(cryptoContext, contextStream, defaultSerType);
 
 #ifdef VERBOSE
@@ -34,7 +35,7 @@ void BatchedFHEPSIServer::receiveAndSetContextAndKeys()
     // Deserialize public key
     vector<unsigned char> pkVector;
     channel->readWithSizeIntoVector(pkVector);
-    auto pKStream = std::istringstream(std::string(pkVector.begin(), pkVector.end()));
+    FrameInStream pKStream(pkVector);
     lbcrypto::Serial::Deserialize(pK, pKStream, defaultSerType);
 
 #ifdef VERBOSE
@@ -45,7 +46,7 @@ void BatchedFHEPSIServer::receiveAndSetContextAndKeys()
 
     vector<unsigned char> mKVector;
     channel->readWithSizeIntoVector(mKVector);
-    auto mKStream = std::istringstream(std::string(mKVector.begin(), mKVector.end()));
+    FrameInStream mKStream(mKVector);
     cryptoContext->DeserializeEvalMultKey(mKStream, defaultSerType);
 
 #ifdef VERBOSE
@@ -59,10 +60,8 @@ void BatchedFHEPSIServer::runSetUpPhase()
     uint64_t neededHfs = htParams.numberOfSimpleHashFunctions + htParams.numberOfCuckooHashFunctions;
     hashfunction = TabulationHashing(serverParams.hashSeed, neededHfs);
 
-    if (serverParams.numberOfThreads < 1)
-    {
-        throw invalid_argument("Number of threads need to be larger than 0");
-    }
+    // Only deserializes the received ciphertexts, the PIE itself runs multi-threaded within OpenFHE
+    startPool();
 
     receiveAndSetContextAndKeys();
 
@@ -91,8 +90,11 @@ void BatchedFHEPSIServer::runOfflinePhase()
 
 void BatchedFHEPSIServer::runOnlinePhase()
 {
-    auto encMinEl = receiveEncryptedMinusElements();
-    auto indMatrix = receiveIndexMatrix();
+    lbcrypto::Ciphertext<FHEEncType> encMinEl;
+    receiveCiphertext(encMinEl);
+    vector<vector<lbcrypto::Ciphertext<FHEEncType>>> indMatrix;
+    receiveIndexMatrix(indMatrix);
+    pool->wait();
 
 
     chrono::steady_clock::time_point end;
@@ -100,53 +102,59 @@ void BatchedFHEPSIServer::runOnlinePhase()
     
     batchedEqualityTest->setMinusCompareElement(encMinEl);
     batchedEqualityTest->setIndex(std::move(indMatrix));
-    batchedEqualityTest->run();
+
+    // Each bin result is serialized and sent while the next bins are computed
+    vector<lbcrypto::Ciphertext<FHEEncType>> &resultList = batchedEqualityTest->getResultList();
+    OrderedSender resultSender(resultList.size(), [this, &resultList](size_t binIndex)
+                               { sendResult(resultList[binIndex]); });
+    for (size_t binIndex = 0; binIndex < resultList.size(); binIndex++)
+    {
+        batchedEqualityTest->runBin(binIndex);
+        resultSender.complete(binIndex);
+    }
 
     end = chrono::steady_clock::now();
     onlineComputation = chrono::duration_cast<chrono::microseconds>(end - begin).count();
 
-    sendResult(batchedEqualityTest->getResultList());
+    resultSender.finish();
     if (serverParams.exportPerformance) {
         exportMeasurements();
     }
 }
 
-lbcrypto::Ciphertext<FHEEncType> BatchedFHEPSIServer::receiveEncryptedMinusElements()
+/**
+ * @brief Reads the frame of one ciphertext and queues its deserialization into ciphertext, which is set after pool->wait().
+ */
+void BatchedFHEPSIServer::receiveCiphertext(lbcrypto::Ciphertext<FHEEncType> &ciphertext)
 {
-    lbcrypto::Ciphertext<FHEEncType> encryptedMinusElements;
-    vector<unsigned char> cipherVector;
-    channel->readWithSizeIntoVector(cipherVector);
-    auto ctSS = std::istringstream(std::string(cipherVector.begin(), cipherVector.end()));
-    lbcrypto::Serial::Deserialize(encryptedMinusElements, ctSS, defaultSerType);
-    return encryptedMinusElements;
+    shared_ptr<vector<vector<unsigned char>>> frames = readFrames(1);
+    lbcrypto::Ciphertext<FHEEncType> *target = &ciphertext;
+    pool->submit([this, frames, target](size_t)
+                 {
+                     FrameInStream ctSS((*frames)[0]);
+                     lbcrypto::Serial::Deserialize(*target, ctSS, defaultSerType);
+                     channel->recycle(*frames); });
 }
 
-vector<vector<lbcrypto::Ciphertext<FHEEncType>>> BatchedFHEPSIServer::receiveIndexMatrix()
+/**
+ * @brief indexMatrix is complete after pool->wait(), see receiveCiphertext.
+ */
+void BatchedFHEPSIServer::receiveIndexMatrix(vector<vector<lbcrypto::Ciphertext<FHEEncType>>> &indexMatrix)
 {
-    vector<vector<lbcrypto::Ciphertext<FHEEncType>>> indexMatrix(htParams.numberOfCuckooHashFunctions,
-                                                                 vector<lbcrypto::Ciphertext<FHEEncType>>(htParams.eachCuckooTableSize));
+    indexMatrix.assign(htParams.numberOfCuckooHashFunctions, vector<lbcrypto::Ciphertext<FHEEncType>>(htParams.eachCuckooTableSize));
     for (uint outerIndex = 0; outerIndex < htParams.numberOfCuckooHashFunctions; outerIndex++)
     {
         for (size_t innerIndex = 0; innerIndex < htParams.eachCuckooTableSize; innerIndex++)
         {
-            lbcrypto::Ciphertext<FHEEncType> ciphertext;
-            vector<unsigned char> cipherVector;
-            channel->readWithSizeIntoVector(cipherVector);
-            auto ctSS = std::istringstream(std::string(cipherVector.begin(), cipherVector.end()));
-            lbcrypto::Serial::Deserialize(ciphertext, ctSS, defaultSerType);
-            indexMatrix[outerIndex][innerIndex] = ciphertext;
+            receiveCiphertext(indexMatrix[outerIndex][innerIndex]);
         }
     }
-    return indexMatrix;
 }
 
-void BatchedFHEPSIServer::sendResult(vector<lbcrypto::Ciphertext<FHEEncType>> &resultVector)
+void BatchedFHEPSIServer::sendResult(lbcrypto::Ciphertext<FHEEncType> &result)
 {
 
-    for (size_t i = 0; i < resultVector.size(); i++)
-    {
-        auto cSerStream = std::ostringstream();
-        lbcrypto::Serial::Serialize(resultVector[i], cSerStream, defaultSerType);
-        channel->writeWithSize(cSerStream.str());
-    }
+    StringOutStream cSerStream;
+    lbcrypto::Serial::Serialize(result, cSerStream, defaultSerType);
+    channel->writeWithSize(cSerStream.take());
 }
@@ -9,6 +9,7 @@
 #include "src/Common/Hashing/HierarchicalCuckooHashTable.hpp"
 #include "src/Common/Crypto/PrivateIndexedEqualityCheck/BatchedFHEHIPPIE.hpp"
 #include "src/Common/Parameter/HashTableParameter.hpp"
+#include "src/Common/OrderedSender.hpp"
 #include <chrono>
 
 class BatchedFHEPSIServer : public PSIServer
@@ -23,9 +24,9 @@ private:
     TabulationHashing hashfunction;
 
     void receiveAndSetContextAndKeys();
-    vector<vector<lbcrypto::Ciphertext<FHEEncType>>> receiveIndexMatrix();
-    lbcrypto::Ciphertext<FHEEncType> receiveEncryptedMinusElements();
-    void sendResult(vector<lbcrypto::Ciphertext<FHEEncType>> &resultVector);
+    void receiveIndexMatrix(vector<vector<lbcrypto::Ciphertext<FHEEncType>>> &indexMatrix);
+    void receiveCiphertext(lbcrypto::Ciphertext<FHEEncType> &ciphertext);
+    void sendResult(lbcrypto::Ciphertext<FHEEncType> &result);
     inline std::string protocolName()
     {
         return "BatchedFHE";
@@ -6,6 +6,7 @@
  */
 #include "SimpleFHEPSIServer.hpp"
 #include "src/Common/DataInput/RandomDataInput.hpp"
+#include "src/Common/WireStreams.hpp"
 #include "ciphertext-ser.h"
 #include "cryptocontext-ser.h"
 #include "key/key-ser.h"
@@ -24,7 +25,7 @@ void SimpleFHEPSIServer::receiveAndSetContextAndKeys()
     // Dererialize crypto context
     vector<unsigned char> contextVector;
     channel->readWithSizeIntoVector(contextVector);
-    auto contextStream = std::istringstream(std::string(contextVector.begin(), contextVector.end()));
+    FrameInStream contextStream(contextVector);
     lbcrypto::Serial::Deserialize(cryptoContext, contextStream, defaultSerType);
 
 #ifdef VERBOSE
@@ -34,7 +35,7 @@ void SimpleFHEPSIServer::receiveAndSetContextAndKeys()
     // Deserialize public key
     vector<unsigned char> pkVector;
     channel->readWithSizeIntoVector(pkVector);
-    auto pKStream = std::istringstream(std::string(pkVector.begin(), pkVector.end()));
+    FrameInStream pKStream(pkVector);
     lbcrypto::Serial::Deserialize(pK, pKStream, defaultSerType);
 
 #ifdef VERBOSE
@@ -45,7 +46,7 @@ void SimpleFHEPSIServer::receiveAndSetContextAndKeys()
 
     vector<unsigned char> sKVector;
     channel->readWithSizeIntoVector(sKVector);
-    auto sKStream = std::istringstream(std::string(sKVector.begin(), sKVector.end()));
+    FrameInStream sKStream(sKVector);
     cryptoContext->DeserializeEvalSumKey(sKStream, defaultSerType);
 
 #ifdef VERBOSE
@@ -56,7 +57,7 @@ void SimpleFHEPSIServer::receiveAndSetContextAndKeys()
 
     vector<unsigned char> erVector;
     channel->readWithSizeIntoVector(erVector);
-    auto erSS = std::istringstream(std::string(erVector.begin(), erVector.end()));
+    FrameInStream erSS(erVector);
     cryptoContext->DeserializeEvalAutomorphismKey(erSS, defaultSerType);
 
 #ifdef VERBOSE
@@ -70,10 +71,7 @@ void SimpleFHEPSIServer::runSetUpPhase()
     uint64_t neededHfs = htParams.numberOfSimpleHashFunctions + htParams.numberOfCuckooHashFunctions;
     hashfunction = TabulationHashing(serverParams.hashSeed, neededHfs);
 
-    if (serverParams.numberOfThreads < 1)
-    {
-        throw invalid_argument("Number of threads need to be larger than 0");
-    }
+    startPool();
 
     receiveAndSetContextAndKeys();
 
@@ -83,11 +81,6 @@ void SimpleFHEPSIServer::runSetUpPhase()
                                                                htParams.numberOfCuckooHashFunctions, htParams.simpleMultiTable, htParams.cuckooMultiTable, htParams.maxItemsPerPosition);
 
     nPiesToHandle = serverHashTable->getNumberOfSimpleTables() * serverHashTable->getEachSimpleTableSize();
-
-    if (nPiesToHandle % serverParams.numberOfThreads != 0)
-    {
-        throw invalid_argument("Error: Number of Threads does not divide number of PIEs");
-    }
 }
 void SimpleFHEPSIServer::runOfflinePhase()
 {
@@ -95,96 +88,82 @@ void SimpleFHEPSIServer::runOfflinePhase()
     // Insert Elements into Cuckoo table
     serverHashTable->insertAll(serverSet);
 
-    piesPerCollection = nPiesToHandle / serverParams.numberOfThreads; // Rounds up
-
-    threadsPIE = vector<boost::thread *>(serverParams.numberOfThreads);
-
     /** Build PIEs (WARNING currently need to do this after the cuckoo table has been inserted with items
      * because of item type conversion during PIE creation)
      */
-    equalityTests = std::vector<std::shared_ptr<FHEHIPPIECollection>>(serverParams.numberOfThreads);
-    for (size_t i = 0; i < equalityTests.size(); i++)
-    {
-        equalityTests[i] = make_shared<FHEHIPPIECollection>(cryptoContext, pK);
-    }
-
+    equalityTests = make_shared<FHEHIPPIECollection>(cryptoContext, pK, nPiesToHandle);
     for (uint i = 0; i < serverHashTable->getNumberOfSimpleTables(); i++)
     {
 
         for (uint j = 0; j < serverHashTable->getEachSimpleTableSize(); j++)
         {
-            uint collectionIndex = (i * serverHashTable->getEachSimpleTableSize() + j) / piesPerCollection;
-
-            equalityTests[collectionIndex]->addPIE(serverHashTable->hierarchicalCuckooTable[i][j]);
+            size_t pieNumber = i * serverHashTable->getEachSimpleTableSize() + j;
+            CuckooHashTable *ct = &serverHashTable->hierarchicalCuckooTable[i][j];
+            pool->submit([this, pieNumber, ct](size_t)
+                         { equalityTests->addPIE(pieNumber, *ct); });
         }
     }
-}
-
-void threadTask(std::shared_ptr<FHEHIPPIECollection> &pieCollection)
-{
-    pieCollection->runAll();
+    pool->wait();
 }
 
 void SimpleFHEPSIServer::runOnlinePhase()
 {
+    // Results leave as the PIEs complete, while later ones are still received and run
+    serializedResults.assign(nPiesToHandle, vector<string>());
+    shared_ptr<OrderedSender> resultSender = make_shared<OrderedSender>(nPiesToHandle, [this](size_t pieNumber)
+                                                                        { sendResult(serializedResults[pieNumber]); });
 
     for (uint i = 0; i < serverHashTable->getNumberOfSimpleTables(); i++)
     {
         for (uint j = 0; j < serverHashTable->getEachSimpleTableSize(); j++)
         {
-            uint pieNumber = (i * serverHashTable->getEachSimpleTableSize() + j);
-            uint collectionIndex = pieNumber / piesPerCollection;
-            uint pieNumberInsideCollection = pieNumber % piesPerCollection;
-
-            // cout << "Receive index matrix" << endl;
-            vector<lbcrypto::Ciphertext<FHEEncType>> indexMatrix = receiveIndexMatrix();
-
-            FHEHIPPIE &currentPIE = equalityTests[collectionIndex]->myPIEs[pieNumberInsideCollection];
-            // cout << "Run PIE" << endl;
-            currentPIE.setIndex(std::move(indexMatrix));
-
-            if (pieNumberInsideCollection == piesPerCollection - 1 || pieNumber == nPiesToHandle - 1)
-            {
-                // Start PIE thread
-                auto &pieCollToRun = equalityTests[collectionIndex];
-                threadsPIE[collectionIndex] = new boost::thread(threadTask, pieCollToRun);
-            }
+            size_t pieNumber = i * serverHashTable->getEachSimpleTableSize() + j;
+
+            // Index matrix, deserialized by the task
+            shared_ptr<vector<vector<unsigned char>>> frames = readFrames(htParams.numberOfCuckooHashFunctions);
+
+            // Runs while the inputs of the next PIEs are received
+            pool->submit([this, pieNumber, frames, resultSender](size_t)
+                         {
+                             equalityTests->myPIEs[pieNumber]->setIndex(decodeIndexMatrix(*frames));
+                             channel->recycle(*frames);
+                             equalityTests->runPIE(pieNumber);
+                             serializedResults[pieNumber] = serializeResult(equalityTests->myPIEs[pieNumber]->getResultList());
+                             resultSender->complete(pieNumber); });
         }
     }
 
-    for (size_t collectionIndex = 0; collectionIndex < serverParams.numberOfThreads; collectionIndex++)
-    {
-        threadsPIE[collectionIndex]->join();
-        for (FHEHIPPIE &pie : equalityTests[collectionIndex]->myPIEs)
-        {
-            sendResult(pie.getResultList());
-        }
-        delete threadsPIE[collectionIndex];
-    }
+    pool->wait();
+    resultSender->finish();
 }
 
-vector<lbcrypto::Ciphertext<FHEEncType>> SimpleFHEPSIServer::receiveIndexMatrix()
+vector<lbcrypto::Ciphertext<FHEEncType>> SimpleFHEPSIServer::decodeIndexMatrix(vector<vector<unsigned char>> &frames)
 {
-    vector<lbcrypto::Ciphertext<FHEEncType>> indexMatrix(htParams.numberOfCuckooHashFunctions);
-    for (uint outerIndex = 0; outerIndex < htParams.numberOfCuckooHashFunctions; outerIndex++)
+    vector<lbcrypto::Ciphertext<FHEEncType>> indexMatrix(frames.size());
+    for (size_t outerIndex = 0; outerIndex < frames.size(); outerIndex++)
     {
-        lbcrypto::Ciphertext<FHEEncType> ciphertext;
-        vector<unsigned char> cipherVector;
-        channel->readWithSizeIntoVector(cipherVector);
-        auto ctSS = std::istringstream(std::string(cipherVector.begin(), cipherVector.end()));
-        lbcrypto::Serial::Deserialize(ciphertext, ctSS, defaultSerType);
-        indexMatrix[outerIndex] = ciphertext;
+        FrameInStream ctSS(frames[outerIndex]);
+        lbcrypto::Serial::Deserialize(indexMatrix[outerIndex], ctSS, defaultSerType);
     }
     return indexMatrix;
 }
 
-void SimpleFHEPSIServer::sendResult(vector<lbcrypto::Ciphertext<FHEEncType>> &resultVector)
+vector<string> SimpleFHEPSIServer::serializeResult(vector<lbcrypto::Ciphertext<FHEEncType>> &resultVector)
 {
 
+    vector<string> serializedResult(resultVector.size());
+    size_t serializedSize = 4096; // all ciphertexts have about the same size, start each with the size of the previous one
     for (size_t i = 0; i < resultVector.size(); i++)
     {
-        auto cSerStream = std::ostringstream();
+        StringOutStream cSerStream(serializedSize);
         lbcrypto::Serial::Serialize(resultVector[i], cSerStream, defaultSerType);
-        channel->writeWithSize(cSerStream.str());
+        serializedSize = cSerStream.size();
+        serializedResult[i] = cSerStream.take();
     }
+    return serializedResult;
+}
+
+void SimpleFHEPSIServer::sendResult(vector<string> &serializedResult)
+{
+    channel->writeBatch(std::move(serializedResult));
 }
@@ -9,6 +9,7 @@
 #include "src/Common/Hashing/HierarchicalCuckooHashTable.hpp"
 #include "src/Common/Crypto/PrivateIndexedEqualityCheck/PIECollection.hpp"
 #include "src/Common/Parameter/HashTableParameter.hpp"
+#include "src/Common/OrderedSender.hpp"
 
 class SimpleFHEPSIServer : public PSIServer
 {
@@ -16,17 +17,17 @@ class SimpleFHEPSIServer : public PSIServer
 private:
     const HashTableParameter &htParams;
     shared_ptr<HierarchicalCuckooHashTable> serverHashTable;
-    vector<std::shared_ptr<FHEHIPPIECollection>> equalityTests;
+    std::shared_ptr<FHEHIPPIECollection> equalityTests;
     lbcrypto::CryptoContext<lbcrypto::DCRTPoly> cryptoContext;
     lbcrypto::PublicKey<FHEEncType> pK;
     TabulationHashing hashfunction;
-    vector<boost::thread *> threadsPIE;
     size_t nPiesToHandle;
-    size_t piesPerCollection;
+    vector<vector<string>> serializedResults; // [pie], serialized results of the current session, ready to be sent
 
     void receiveAndSetContextAndKeys();
-    vector<lbcrypto::Ciphertext<FHEEncType>> receiveIndexMatrix();
-    void sendResult(vector<lbcrypto::Ciphertext<FHEEncType>> &resultVector);
+    vector<lbcrypto::Ciphertext<FHEEncType>> decodeIndexMatrix(vector<vector<unsigned char>> &frames);
+    vector<string> serializeResult(vector<lbcrypto::Ciphertext<FHEEncType>> &resultVector);
+    void sendResult(vector<string> &serializedResult);
     inline std::string protocolName()
     {
         return "SimpleFHE";
@@ -13,6 +13,8 @@
 #include "src/Common/DataInput/DataInputHandler.hpp"
 #include "src/Common/Parameter/PSIParameter.hpp"
 #include "src/Common/Utils.hpp"
+#include "src/Common/WorkStealingPool.hpp"
+#include "src/Common/AsyncChannel.hpp"
 
 class PSIServer
 {
@@ -20,27 +22,49 @@ class PSIServer
 protected:
     PSIParameter &serverParams;
     std::vector<biginteger> &serverSet;
-    shared_ptr<CommParty> channel;
-    boost::asio::io_service io_service;
-    // boost::thread t;
+    shared_ptr<AsyncChannel> channel;
     string exportFileName;
     string protocolName;
     int64_t offlineComputation;
     int64_t onlineComputation;
+    std::unique_ptr<WorkStealingPool> pool; // Runs the PIE tasks of all phases, see startPool
+
+    /**
+     * @brief Starts numberOfThreads workers, which stay alive for the whole run.
+     */
+    void startPool()
+    {
+        if (serverParams.numberOfThreads < 1)
+        {
+            throw invalid_argument("Number of threads need to be larger than 0");
+        }
+        pool.reset(new WorkStealingPool(serverParams.numberOfThreads));
+    }
+
+    /**
+     * @brief Reads the raw frames of the next numberOfFrames messages, e.g., the ciphertexts of one PIE. The socket thread
+     *        only reads bytes, a pool task decodes them, i.e., decoding runs in parallel and while the next frames are read.
+     *        The task hands the decoded frames back with channel->recycle, the channel then reads the next messages into them.
+     *        Shared, since std::function needs a copyable callable.
+     */
+    shared_ptr<vector<vector<unsigned char>>> readFrames(size_t numberOfFrames)
+    {
+        auto frames = make_shared<vector<vector<unsigned char>>>(numberOfFrames);
+        for (auto &frame : *frames)
+        {
+            channel->readWithSizeIntoVector(frame);
+        }
+        return frames;
+    }
 
     void connectToClient()
     {
-        // t = boost::thread(boost::bind(&boost::asio::io_service::run, &io_service));
-        auto me = SocketPartyData(boost_ip::address::from_string(serverParams.ip), serverParams.port + 1);
-        auto other = SocketPartyData(boost_ip::address::from_string(serverParams.ip), serverParams.port);
-        channel = make_shared<CommPartyTCPSynced>(io_service, me, other, 0);
-        channel->join(500, 5000000);
+        channel = AsyncChannel::accept(serverParams.ip, serverParams.port, serverParams.numberOfStreams);
     }
 
     void closeConnection()
     {
-        io_service.stop();
-        // t.join();
+        channel->close();
     }
 
     void signalPhaseOver()
@@ -0,0 +1,94 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "src/Common/AsyncChannel.hpp"
+#include "boost/program_options.hpp"
+namespace po = boost::program_options;
+
+using namespace std;
+
+/**
+ * @brief Sends nMessages messages of msgSize bytes (about one encoded ECC ElGamal ciphertext by default) over loopback,
+ *        in batches of one PIE result, and reports time and operations per message with and without coalescing.
+ *        The receiver reads each batch into fresh frames, as PSIServer::readFrames, and hands them back with recycle or
+ *        drops them, allocations counts the received messages that did not fit into a reused buffer.
+ *        To see the effect of --streams, emulate a long link on loopback, e.g., tc qdisc add dev lo root netem delay 20ms,
+ *        and send large messages (FHE ciphertexts).
+ */
+int main(int argc, char *argv[])
+{
+    uint64_t numberOfMessages;
+    uint64_t messageSize;
+    uint64_t batchSize;
+    size_t numberOfStreams;
+    int port;
+    bool help;
+    // Declare the supported options.
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", po::bool_switch(&help), "produce help message")
+        ("nMessages", po::value<uint64_t>(&numberOfMessages)->default_value(1000000), "Number of messages to send")
+        ("msgSize", po::value<uint64_t>(&messageSize)->default_value(66), "Size of each message in bytes")
+        ("batch", po::value<uint64_t>(&batchSize)->default_value(16), "Messages queued at once")
+        ("streams", po::value<size_t>(&numberOfStreams)->default_value(1), "Parallel TCP connections")
+        ("port", po::value<int>(&port)->default_value(8200), "First loopback port");
+
+    po::variables_map vm;
+    po::store(parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (help)
+    {
+        cout << desc << "\n";
+        return 0;
+    }
+
+    cout << "mode;recycle;streams;messages;messageSize;ms;writeOps;readOps;allocations;bytes;overheadPerMessage;MBitPerSecond" << endl;
+    for (bool coalescing : {false, true})
+    {
+        for (bool recycle : {false, true})
+        {
+            shared_ptr<AsyncChannel> receiver;
+            thread acceptor([&receiver, port, numberOfStreams, coalescing]
+                            { receiver = AsyncChannel::accept("127.0.0.1", port, numberOfStreams, coalescing); });
+            shared_ptr<AsyncChannel> sender = AsyncChannel::connect("127.0.0.1", port, 50, 10000, numberOfStreams, coalescing);
+            acceptor.join();
+            port++;
+
+            auto begin = chrono::steady_clock::now();
+            thread receiving([&receiver, numberOfMessages, batchSize, recycle]
+                             {
+                                 for (uint64_t received = 0; received < numberOfMessages; received += batchSize)
+                                 {
+                                     vector<vector<unsigned char>> frames(min(batchSize, numberOfMessages - received));
+                                     for (auto &frame : frames)
+                                     {
+                                         receiver->readWithSizeIntoVector(frame);
+                                     }
+                                     if (recycle)
+                                     {
+                                         receiver->recycle(frames);
+                                     }
+                                 } });
+            for (uint64_t sent = 0; sent < numberOfMessages; sent += batchSize)
+            {
+                vector<string> batch(min(batchSize, numberOfMessages - sent), string(messageSize, 'c'));
+                sender->writeBatch(move(batch));
+            }
+            receiving.join();
+            auto ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - begin).count();
+
+            uint64_t bytes = sender->takeBytesOut();
+            cout << (coalescing ? "coalescing" : "per message") << ";" << recycle << ";" << numberOfStreams << ";" << numberOfMessages << ";" << messageSize << ";"
+                 << ms << ";" << sender->getWriteOperations() << ";" << receiver->getReadOperations() << ";"
+                 << receiver->getBufferAllocations() << ";" << bytes << ";"
+                 << double(bytes - numberOfMessages * messageSize) / numberOfMessages << ";" << bytes * 8.0 / 1000 / max<int64_t>(ms, 1)
+                 << endl;
+            sender->close();
+            receiver->close();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include "src/Common/AsyncChannel.hpp"
+#include "tests/TestChecks.hpp"
+
+using namespace std;
+
+string message(size_t i)
+{
+    return string(i % 1000, char('a' + i % 26)) + to_string(i);
+}
+
+/**
+ * @brief Sends and receives on both ends of a loopback connection at the same time, from two sending threads per party
+ *        (one of them sends batches), and checks order, contents and the byte accounting of both parties, as well as the
+ *        error once the other party closed.
+ */
+bool testChannel(int port, bool coalescing, size_t numberOfStreams)
+{
+    const string ip = "127.0.0.1";
+    const string mode = string(coalescing ? " (coalescing, " : " (per message, ") + to_string(numberOfStreams) + " streams)";
+    const size_t numberOfMessages = 20000;
+    uint64_t expectedBytes = 0;
+    for (size_t i = 0; i < numberOfMessages; i++)
+    {
+        expectedBytes += 4 + message(i).size();
+    }
+
+    shared_ptr<AsyncChannel> server;
+    thread acceptor([&server, &ip, port, numberOfStreams, coalescing]
+                    { server = AsyncChannel::accept(ip, port, numberOfStreams, coalescing); });
+    shared_ptr<AsyncChannel> client = AsyncChannel::connect(ip, port, 50, 10000, numberOfStreams, coalescing);
+    acceptor.join();
+
+    bool allPassed = true;
+    for (auto &party : {server, client})
+    {
+        // Even messages one by one, odd messages in batches of 100, each thread's messages keep their order
+        thread evenSender([&party, numberOfMessages]
+                          { for (size_t i = 0; i < numberOfMessages; i += 2) party->writeWithSize(message(i)); });
+        thread oddSender([&party, numberOfMessages]
+                         {
+                             vector<string> batch;
+                             for (size_t i = 1; i < numberOfMessages; i += 2)
+                             {
+                                 batch.push_back(message(i));
+                                 if (batch.size() == 100 || i + 2 >= numberOfMessages)
+                                 {
+                                     party->writeBatch(move(batch));
+                                     batch.clear();
+                                 }
+                             } });
+        evenSender.join();
+        oddSender.join();
+        party->flush();
+    }
+
+    for (auto &party : {server, client})
+    {
+        const string name = (party == server ? "server" : "client") + mode;
+        vector<string> received;
+        vector<unsigned char> frame;
+        for (size_t i = 0; i < numberOfMessages; i++)
+        {
+            party->readWithSizeIntoVector(frame);
+            received.push_back(string(frame.begin(), frame.end()));
+        }
+        size_t nextEven = 0, nextOdd = 1;
+        bool inOrder = true;
+        for (auto &text : received)
+        {
+            if (nextEven < numberOfMessages && text == message(nextEven))
+            {
+                nextEven += 2;
+            }
+            else if (nextOdd < numberOfMessages && text == message(nextOdd))
+            {
+                nextOdd += 2;
+            }
+            else
+            {
+                inOrder = false;
+            }
+        }
+        allPassed &= check(inOrder, name + " receives all messages in order");
+        allPassed &= check(party->takeBytesIn() == expectedBytes && party->takeBytesOut() == expectedBytes, name + " byte accounting");
+        allPassed &= check(party->takeBytesIn() == 0, name + " bytes are taken per phase");
+        // Without coalescing, each message takes one write and two reads
+        allPassed &= check(coalescing ? party->getWriteOperations() < numberOfMessages : party->getWriteOperations() == numberOfMessages,
+                           name + " write operations");
+    }
+
+    client->writeBatch({"", "last"});
+    client->close();
+    vector<unsigned char> frame;
+    server->readWithSizeIntoVector(frame);
+    bool empty = frame.empty();
+    server->readWithSizeIntoVector(frame);
+    bool closed = false;
+    try
+    {
+        server->readWithSizeIntoVector(frame);
+    }
+    catch (runtime_error &)
+    {
+        closed = true;
+    }
+    allPassed &= check(empty && string(frame.begin(), frame.end()) == "last" && closed,
+                       "messages before close arrive, then reading fails" + mode);
+    return allPassed;
+}
+
+/**
+ * @brief Sends more than maxReceiveQueueBytes before the receiver starts reading, i.e., reading pauses and has to resume
+ *        on all streams.
+ */
+bool testReadAhead(int port, size_t numberOfStreams)
+{
+    const size_t numberOfMessages = 100;
+    shared_ptr<AsyncChannel> server;
+    thread acceptor([&server, port, numberOfStreams]
+                    { server = AsyncChannel::accept("127.0.0.1", port, numberOfStreams); });
+    shared_ptr<AsyncChannel> client = AsyncChannel::connect("127.0.0.1", port, 50, 10000, numberOfStreams);
+    acceptor.join();
+
+    vector<string> batch;
+    for (size_t i = 0; i < numberOfMessages; i++)
+    {
+        batch.push_back(string(1024 * 1024, char('a' + i % 26)));
+    }
+    client->writeBatch(move(batch));
+    this_thread::sleep_for(chrono::milliseconds(200));
+
+    bool correct = true;
+    vector<unsigned char> frame;
+    for (size_t i = 0; i < numberOfMessages; i++)
+    {
+        server->readWithSizeIntoVector(frame);
+        correct &= frame.size() == 1024 * 1024 && frame[0] == 'a' + i % 26;
+    }
+    client->close();
+    return check(correct, "read ahead pauses and resumes (" + to_string(numberOfStreams) + " streams)");
+}
+
+/**
+ * @brief Both parties must use the same number of streams.
+ */
+bool testStreamMismatch(int port)
+{
+    bool refused = false;
+    thread acceptor([&refused, port]
+                    {
+                        try
+                        {
+                            AsyncChannel::accept("127.0.0.1", port, 3);
+                        }
+                        catch (runtime_error &)
+                        {
+                            refused = true;
+                        } });
+    try
+    {
+        AsyncChannel::connect("127.0.0.1", port, 50, 500, 2);
+    }
+    catch (runtime_error &)
+    {
+    }
+    acceptor.join();
+    return check(refused, "different numbers of streams are refused");
+}
+
+/**
+ * @brief Frames handed back with recycle take the next received messages, as the frames of PSIServer::readFrames.
+ */
+bool testRecycle(int port)
+{
+    shared_ptr<AsyncChannel> server;
+    thread acceptor([&server, port]
+                    { server = AsyncChannel::accept("127.0.0.1", port); });
+    shared_ptr<AsyncChannel> client = AsyncChannel::connect("127.0.0.1", port, 50, 10000);
+    acceptor.join();
+
+    const size_t batchSize = 16;
+    bool correct = true;
+    for (size_t round = 0; round < 10; round++)
+    {
+        client->writeBatch(vector<string>(batchSize, string(1000, char('a' + round))));
+        vector<vector<unsigned char>> frames(batchSize);
+        for (auto &frame : frames)
+        {
+            server->readWithSizeIntoVector(frame);
+            correct &= frame.size() == 1000 && frame[0] == 'a' + round;
+        }
+        server->recycle(frames);
+        correct &= frames.empty();
+    }
+    // The first round allocates, later ones reuse its buffers (and at most one buffer in flight per round)
+    bool reused = server->getBufferAllocations() < 3 * batchSize;
+    client->close();
+    server->close();
+    return check(correct && reused, "recycled frames are reused");
+}
+
+/**
+ * @brief Closing the channel makes a read that waits for a message throw, the client relies on it to stop its receiver.
+ */
+bool testCloseWakesReader(int port)
+{
+    shared_ptr<AsyncChannel> server;
+    thread acceptor([&server, port]
+                    { server = AsyncChannel::accept("127.0.0.1", port, 2); });
+    shared_ptr<AsyncChannel> client = AsyncChannel::connect("127.0.0.1", port, 50, 10000, 2);
+    acceptor.join();
+
+    bool thrown = false;
+    thread reader([&client, &thrown]
+                  {
+                      vector<unsigned char> frame;
+                      try
+                      {
+                          client->readWithSizeIntoVector(frame);
+                      }
+                      catch (runtime_error &)
+                      {
+                          thrown = true;
+                      } });
+    this_thread::sleep_for(chrono::milliseconds(100));
+    client->close();
+    reader.join();
+    server->close();
+    return check(thrown, "close wakes a waiting reader");
+}
+
+int main(int argc, char *argv[])
+{
+    bool allPassed = testChannel(8123, true, 1);
+    allPassed &= testChannel(8124, false, 1);
+    allPassed &= testChannel(8125, true, 4);
+    allPassed &= testChannel(8126, false, 3);
+    allPassed &= testReadAhead(8127, 1);
+    allPassed &= testReadAhead(8128, 4);
+    allPassed &= testStreamMismatch(8129);
+    allPassed &= testCloseWakesReader(8130);
+    allPassed &= testRecycle(8131);
+
+    return checksResult(allPassed);
+}
@@ -0,0 +1,25 @@
+/**
+ * @file TestChecks.hpp
+ *
+ * @brief Reporting of the self-checking tests: one line per check and a summary, the exit code tells if all passed.
+ * @version 0.1
+ *
+ */
+#pragma once
+#include <iostream>
+#include <string>
+
+inline bool check(bool condition, const std::string &name)
+{
+    std::cout << (condition ? "OK    " : "FAILED ") << name << std::endl;
+    return condition;
+}
+
+/**
+ * @brief Prints the summary, the return value is meant for main.
+ */
+inline int checksResult(bool allPassed)
+{
+    std::cout << (allPassed ? "All checks passed" : "Some checks FAILED") << std::endl;
+    return allPassed ? 0 : 1;
+}
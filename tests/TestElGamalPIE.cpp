@@ -165,7 +165,8 @@ int main(int argc, char *argv[])
 
 
 
-    PrecompElGamalPIE pie2(encryptor, cT2);
+    CiphertextArena arena;
+    PrecompElGamalPIE pie2(encryptor, arena, cT2);
 
     pie2.setIndex(std::move(precompIndexMatrix));
     pie2.precomp();
@@ -185,4 +186,8 @@ int main(int argc, char *argv[])
             break;
         };
     }
+
+    cout << "Arena: " << arena.getAdoptedCount() << " adopted, " << arena.getNativeInUse() << " native ciphertexts" << endl;
+    pie2.clearInputs();
+    arena.reset();
 }
\ No newline at end of file
@@ -0,0 +1,443 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include "src/Common/Crypto/AddHomElGamalEnc.hpp"
+#include "primitives/DlogOpenSSL.hpp"
+#include "src/PSIConfigs.h"
+#include "tests/TestChecks.hpp"
+
+/**
+ * @brief Compares the libscapi backend of AddHomElGamalEnc with the native OpenSSL backend
+ * 		  on the operations of the PIE hot path and checks that both backends interoperate.
+ */
+
+long long measure(const std::function<void()> &f)
+{
+    auto begin = chrono::steady_clock::now();
+    f();
+    auto end = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::microseconds>(end - begin).count();
+}
+
+int main(int argc, char *argv[])
+{
+    string curveName = argc > 1 ? argv[1] : "P-256";
+    size_t vectorSize = argc > 2 ? stoul(argv[2]) : 20;
+    size_t repetitions = argc > 3 ? stoul(argv[3]) : 100;
+
+    shared_ptr<DlogGroup> dlog;
+    if (curveName[0] == 'P')
+    {
+        dlog = make_shared<OpenSSLDlogECFp>(OpenSSLCurveDir, curveName);
+    }
+    else
+    {
+        dlog = make_shared<OpenSSLDlogECF2m>(OpenSSLCurveDir, curveName);
+    }
+
+    AddHomElGamalEnc scapiElGamal(dlog);
+    auto keyPair = scapiElGamal.generateKey();
+    scapiElGamal.setKey(keyPair.first, keyPair.second);
+
+    AddHomElGamalEnc nativeElGamal(dlog);
+    nativeElGamal.setKey(keyPair.first, keyPair.second);
+    nativeElGamal.enableNativeBackend(curveName);
+
+    bool allPassed = true;
+
+    // Correctness and interoperability
+    biginteger zero(0);
+    biginteger five(5);
+    biginteger minusFive(-5);
+    auto scapiFive = scapiElGamal.encrypt(make_shared<BigIntegerPlainText>(five));
+    auto nativeFive = nativeElGamal.encrypt(make_shared<BigIntegerPlainText>(five));
+    auto nativeMinusFive = nativeElGamal.encrypt(make_shared<BigIntegerPlainText>(minusFive));
+
+    allPassed &= check(nativeElGamal.decryptsToZero(nativeElGamal.add(nativeFive.get(), nativeMinusFive.get()).get()), "native add");
+    allPassed &= check(nativeElGamal.decryptsToZero(nativeElGamal.subtract(nativeFive.get(), scapiFive.get()).get()), "mixed subtract");
+    allPassed &= check(!nativeElGamal.decryptsToZero(nativeFive.get()), "native non zero");
+    allPassed &= check(nativeElGamal.decryptsToZero(nativeElGamal.randomizedEquality(nativeMinusFive.get(), five, nativeFive.get()).get()), "native randomized equality");
+
+    for (AddHomElGamalEnc *enc : {&scapiElGamal, &nativeElGamal})
+    {
+        CiphertextArena arena;
+        auto encryptedFive = enc->usesNativeBackend() ? nativeFive.get() : scapiFive.get();
+        auto accumulator = enc->copyPointer(encryptedFive, &arena);
+        enc->multByConstInPlace(accumulator, five);
+        enc->subInPlace(accumulator, encryptedFive);
+        enc->addInPlace(accumulator, accumulator);
+        enc->normalize(accumulator);
+        auto expected = enc->encrypt(make_shared<BigIntegerPlainText>(biginteger(-40)));
+        allPassed &= check(enc->decryptsToZero(enc->add(accumulator, expected.get()).get()), enc->usesNativeBackend() ? "native in-place" : "scapi in-place");
+    }
+
+    auto nativeToScapi = scapiElGamal.reconstructCiphertext(nativeFive->generateSendableData()->toString());
+    allPassed &= check(scapiElGamal.decryptsToZero(scapiElGamal.randomizedEquality(nativeToScapi.get(), minusFive, nullptr).get()), "native -> scapi wire format");
+    auto scapiToNative = nativeElGamal.reconstructCiphertext(scapiFive->generateSendableData()->toString());
+    allPassed &= check(nativeElGamal.decryptsToZero(nativeElGamal.randomizedEquality(scapiToNative.get(), minusFive, nullptr).get()), "scapi -> native wire format");
+
+    // Malformed frames of the client must be refused, not crash the server
+    bool malformedRefused = true;
+    for (const string &malformed : vector<string>{"", "1", "1:2", "1:2:3", "1:2:3:4:5", "x:1:2:3", "1:2:3:", "12ab:1:2:3", "-1:2:3:4"})
+    {
+        try
+        {
+            nativeElGamal.reconstructCiphertext(malformed);
+            malformedRefused = false;
+        }
+        catch (const invalid_argument &)
+        {
+        }
+    }
+    allPassed &= check(malformedRefused, "native refuses malformed ciphertexts");
+
+    // Cached g^item has to give the same results as computing it
+    auto generatorPowers = make_shared<GeneratorPowerCache>(curveName);
+    generatorPowers->build({five, biginteger(7), zero});
+    for (AddHomElGamalEnc *enc : {&scapiElGamal, &nativeElGamal})
+    {
+        enc->setGeneratorPowerCache(generatorPowers);
+        auto encryptedMinusFive = enc->encrypt(make_shared<BigIntegerPlainText>(minusFive));
+        auto negated = enc->elementXorByConstPointer(encryptedMinusFive.get(), five);
+        auto expected = enc->encrypt(make_shared<BigIntegerPlainText>(biginteger(10)));
+        bool cachedCorrect = enc->decryptsToZero(enc->randomizedEquality(encryptedMinusFive.get(), five, nullptr).get()) &&
+                             enc->decryptsToZero(enc->subtract(negated, expected.get()).get());
+        delete negated;
+        enc->setGeneratorPowerCache(nullptr);
+        allPassed &= check(cachedCorrect, enc->usesNativeBackend() ? "native generator power cache" : "scapi generator power cache");
+    }
+
+    auto scapiDecrypted = scapiElGamal.decrypt(scapiFive.get());
+    auto nativeDecrypted = nativeElGamal.decrypt(nativeFive.get());
+    allPassed &= check(*((GroupElementPlaintext *)scapiDecrypted.get())->getElement() == *((GroupElementPlaintext *)nativeDecrypted.get())->getElement(), "decrypt");
+
+    // Encrypted unit vector e_1 and random exponents for the inner product
+    vector<shared_ptr<AsymmetricCiphertext>> scapiIndex(vectorSize);
+    vector<shared_ptr<AsymmetricCiphertext>> nativeIndex(vectorSize);
+    vector<AsymmetricCiphertext *> scapiIndexPtr(vectorSize);
+    vector<AsymmetricCiphertext *> nativeIndexPtr(vectorSize);
+    vector<biginteger> exponents(vectorSize);
+    auto random = get_seeded_prg();
+    for (size_t i = 0; i < vectorSize; i++)
+    {
+        auto plaintext = make_shared<BigIntegerPlainText>(biginteger(i == 1 ? 1 : 0));
+        scapiIndex[i] = scapiElGamal.encrypt(plaintext);
+        nativeIndex[i] = nativeElGamal.encrypt(plaintext);
+        scapiIndexPtr[i] = scapiIndex[i].get();
+        nativeIndexPtr[i] = nativeIndex[i].get();
+        exponents[i] = getRandomInRange(0, scapiElGamal.getQMinusOne(), random.get());
+    }
+
+    biginteger minusExponent = -exponents[1];
+    auto nativeMinusExponent = nativeElGamal.encrypt(make_shared<BigIntegerPlainText>(minusExponent));
+    auto innerProduct = nativeElGamal.homomorphicInnerProduct(nativeIndexPtr, exponents);
+    allPassed &= check(nativeElGamal.decryptsToZero(nativeElGamal.add(innerProduct.get(), nativeMinusExponent.get()).get()), "native inner product");
+
+    // Typed path of the PIE hot loops, libscapi inputs are resolved (converted) once up front
+    vector<unique_ptr<NativeElGamalCiphertext>> convertedIndex(vectorSize);
+    vector<NativeElGamalCiphertext *> typedIndex(vectorSize);
+    for (size_t i = 0; i < vectorSize; i++)
+    {
+        typedIndex[i] = nativeElGamal.toNative(i % 2 == 0 ? nativeIndexPtr[i] : scapiIndexPtr[i], convertedIndex[i]);
+    }
+    unique_ptr<NativeElGamalCiphertext> convertedCompare, convertedZero;
+    auto encryptedZero = nativeElGamal.encrypt(make_shared<BigIntegerPlainText>(zero));
+    auto &typedMinusExponent = *nativeElGamal.toNative(nativeMinusExponent.get(), convertedCompare);
+    auto &typedZero = *nativeElGamal.toNative(encryptedZero.get(), convertedZero);
+    NativeElGamalCiphertext typedResult(*nativeElGamal.getNativeGroup());
+    nativeElGamal.indexedRandomizedEquality(typedResult, typedIndex, exponents, typedMinusExponent, typedZero);
+    bool typedCorrect = nativeElGamal.decryptsToZero(&typedResult);
+    nativeElGamal.randomizedEquality(typedResult, typedMinusExponent, exponents[1]);
+    typedCorrect &= nativeElGamal.decryptsToZero(&typedResult);
+    nativeElGamal.multByConst(typedResult, *typedIndex[1], exponents[1]);
+    nativeElGamal.addInPlace(typedResult, typedMinusExponent);
+    nativeElGamal.normalize(typedResult);
+    typedCorrect &= nativeElGamal.decryptsToZero(&typedResult);
+    allPassed &= check(typedCorrect, "typed native operations");
+
+    // Forks share keys and caches but not the EC group, so they can run the typed operations concurrently (intra-PIE threads)
+    vector<unique_ptr<NativeElGamalCiphertext>> forkedResults;
+    for (size_t i = 0; i < 8; i++)
+    {
+        forkedResults.emplace_back(new NativeElGamalCiphertext(*nativeElGamal.getNativeGroup()));
+    }
+#pragma omp parallel for num_threads(4)
+    for (long i = 0; i < long(forkedResults.size()); i++)
+    {
+        AddHomElGamalEnc fork = nativeElGamal.forkNative();
+        fork.indexedRandomizedEquality(*forkedResults[i], typedIndex, exponents, typedMinusExponent, typedZero);
+    }
+    bool forkedCorrect = true;
+    for (auto &forkedResult : forkedResults)
+    {
+        forkedCorrect &= nativeElGamal.decryptsToZero(forkedResult.get());
+    }
+    allPassed &= check(forkedCorrect, "forked cryptors");
+
+    // Pooled zeros, the pool runs dry after 16 of them and the rest are encrypted directly
+    auto zeroPool = nativeElGamal.newEncryptedZeroPool(16);
+    zeroPool->fill();
+    vector<unique_ptr<NativeElGamalCiphertext>> pooledZeros;
+    vector<NativeElGamalCiphertext *> pooledZeroPtr;
+    for (size_t i = 0; i < 20; i++)
+    {
+        pooledZeros.emplace_back(new NativeElGamalCiphertext(*nativeElGamal.getNativeGroup()));
+        pooledZeroPtr.push_back(pooledZeros.back().get());
+    }
+    nativeElGamal.setEncryptedZeroPool(zeroPool);
+    nativeElGamal.drawEncryptedZeros(pooledZeroPtr);
+    nativeElGamal.setEncryptedZeroPool(nullptr);
+    bool pooledCorrect = zeroPool->available() == 0;
+    for (auto pooledZero : pooledZeroPtr)
+    {
+        pooledCorrect &= nativeElGamal.decryptsToZero(pooledZero) && !nativeElGamal.getNativeGroup()->isInfinity(pooledZero->u);
+    }
+    allPassed &= check(pooledCorrect, "encrypted zero pool");
+
+    // Batched membership check of the received index vector, for binary curves also with a point shifted by the 2-torsion point (0, sqrt(b))
+    allPassed &= check(nativeElGamal.checkMembershipBatch(nativeIndexPtr) && scapiElGamal.checkMembershipBatch(scapiIndexPtr), "membership batch");
+    AddHomElGamalEnc validatingElGamal(dlog);
+    validatingElGamal.enableNativeValidation(curveName);
+    allPassed &= check(validatingElGamal.checkMembershipBatch(scapiIndexPtr), "membership batch with native validation");
+    auto isMemberTime = measure([&]()
+                                { scapiElGamal.checkMembershipBatch(scapiIndexPtr); });
+    auto validationTime = measure([&]()
+                                  { validatingElGamal.checkMembershipBatch(scapiIndexPtr); });
+    cout << "Membership of " << vectorSize << " libscapi ciphertexts: " << isMemberTime << "µs isMember, " << validationTime << "µs native validation" << endl;
+    auto nativeGroupForCheck = nativeElGamal.getNativeGroup();
+    if (EC_GROUP_get_field_type(nativeGroupForCheck->getGroup()) == NID_X9_62_characteristic_two_field)
+    {
+        BigNumPtr polynomial(BN_new()), a(BN_new()), b(BN_new()), sqrtB(BN_new());
+        EC_GROUP_get_curve(nativeGroupForCheck->getGroup(), polynomial.get(), a.get(), b.get(), nativeGroupForCheck->getCTX());
+        BN_GF2m_mod_sqrt(sqrtB.get(), b.get(), polynomial.get(), nativeGroupForCheck->getCTX());
+        NativeECPoint torsion = nativeGroupForCheck->newPoint();
+        nativeGroupForCheck->setAffine(torsion, biginteger(0), bnToBiginteger(sqrtB.get()), false);
+
+        auto shifted = nativeElGamal.copyPointer(nativeIndexPtr[0]);
+        auto &shiftedU = dynamic_cast<NativeElGamalCiphertext *>(shifted)->u;
+        nativeGroupForCheck->add(shiftedU, shiftedU, torsion);
+        nativeElGamal.normalize(shifted);
+        vector<AsymmetricCiphertext *> withShifted(nativeIndexPtr);
+        withShifted.push_back(shifted);
+        allPassed &= check(!nativeElGamal.checkMembershipBatch(withShifted), "membership batch rejects torsion");
+
+        auto shiftedAffine = nativeGroupForCheck->getAffine(shiftedU);
+        vector<biginteger> shiftedCoordinates{shiftedAffine.first, shiftedAffine.second};
+        auto scapiFirst = dynamic_cast<ElGamalOnGroupElementCiphertext *>(scapiIndexPtr[0]);
+        ElGamalOnGroupElementCiphertext scapiShifted(dlog->generateElement(false, shiftedCoordinates), scapiFirst->getC2());
+        vector<AsymmetricCiphertext *> scapiWithShifted(scapiIndexPtr);
+        scapiWithShifted.push_back(&scapiShifted);
+        allPassed &= check(!validatingElGamal.checkMembershipBatch(scapiWithShifted), "native validation rejects torsion");
+        delete shifted;
+    }
+
+    // All groups of a curve share the OpenSSL group with its precomputations, further groups only allocate scratch state
+    NativeECGroup secondGroup(curveName);
+    allPassed &= check(secondGroup.getGroup() == nativeElGamal.getNativeGroup()->getGroup(), "shared curve");
+    auto groupsTime = measure([&]()
+                              { for (int i = 0; i < 64; i++) NativeECGroup perThread(curveName); });
+    cout << "64 native groups of " << curveName << ": " << groupsTime << "µs" << endl;
+
+    // Benchmark
+    cout << "Curve " << curveName << ", vector size " << vectorSize << ", " << repetitions << " repetitions" << endl;
+    cout << "Operation,scapi[µs],native[µs]" << endl;
+
+    auto bench = [&](const string &name, const std::function<void(AddHomElGamalEnc &, vector<AsymmetricCiphertext *> &)> &op)
+    {
+        auto scapiTime = measure([&]()
+                                 { for (size_t r = 0; r < repetitions; r++) op(scapiElGamal, scapiIndexPtr); });
+        auto nativeTime = measure([&]()
+                                  { for (size_t r = 0; r < repetitions; r++) op(nativeElGamal, nativeIndexPtr); });
+        cout << name << "," << scapiTime << "," << nativeTime << endl;
+    };
+
+    bench("encrypt", [&](AddHomElGamalEnc &enc, vector<AsymmetricCiphertext *> &)
+          { enc.encrypt(make_shared<BigIntegerPlainText>(five)); });
+    bench("add", [&](AddHomElGamalEnc &enc, vector<AsymmetricCiphertext *> &index)
+          { enc.add(index[0], index[1]); });
+    bench("addInPlace", [&](AddHomElGamalEnc &enc, vector<AsymmetricCiphertext *> &index)
+          { enc.addInPlace(index[0], index[2]); });
+    bench("multByConst", [&](AddHomElGamalEnc &enc, vector<AsymmetricCiphertext *> &index)
+          { enc.multByConst(index[0], exponents[0]); });
+    bench("innerProduct", [&](AddHomElGamalEnc &enc, vector<AsymmetricCiphertext *> &index)
+          { enc.homomorphicInnerProduct(index, exponents); });
+    auto typedTime = measure([&]()
+                             { for (size_t r = 0; r < repetitions; r++) nativeElGamal.addInPlace(typedResult, *typedIndex[2]); });
+    cout << "addInPlace (typed),," << typedTime << endl;
+
+    auto poolTime = measure([&]()
+                            { nativeElGamal.newEncryptedZeroPool(repetitions)->fill(); });
+    cout << "encrypt zero (pool incl. tables),," << poolTime << endl;
+    bench("randomizedEquality", [&](AddHomElGamalEnc &enc, vector<AsymmetricCiphertext *> &index)
+          { enc.randomizedEquality(index[0], five, nullptr); });
+    bench("decryptsToZero", [&](AddHomElGamalEnc &enc, vector<AsymmetricCiphertext *> &index)
+          { enc.decryptsToZero(index[0]); });
+    bench("encode", [&](AddHomElGamalEnc &enc, vector<AsymmetricCiphertext *> &index)
+          { index[0]->generateSendableData()->toString(); });
+
+    // Encoding with one inversion per point vs. one inversion per batch
+    vector<shared_ptr<AsymmetricCiphertext>> singleNormalized(vectorSize * repetitions);
+    vector<shared_ptr<AsymmetricCiphertext>> batchNormalized(vectorSize * repetitions);
+    for (size_t i = 0; i < singleNormalized.size(); i++)
+    {
+        singleNormalized[i] = nativeElGamal.encrypt(make_shared<BigIntegerPlainText>(zero));
+        batchNormalized[i] = nativeElGamal.encrypt(make_shared<BigIntegerPlainText>(zero));
+    }
+    auto singleTime = measure([&]()
+                              { for (auto &cipher : singleNormalized) cipher->generateSendableData()->toString(); });
+    auto batchTime = measure([&]()
+                             { nativeElGamal.normalizeBatch(batchNormalized);
+                               for (auto &cipher : batchNormalized) cipher->generateSendableData()->toString(); });
+    cout << "encode (single/batch normalization)," << singleTime << "," << batchTime << endl;
+
+    // Multi-exponentiation of u and v: libscapi vs. OpenSSL wNAF vs. Pippenger buckets
+    auto nativeGroup = nativeElGamal.getNativeGroup();
+    cout << "n,window,scapi[µs],wNAF[µs],Pippenger[µs]" << endl;
+    for (size_t n : {vectorSize, size_t(64), size_t(256), size_t(1024)})
+    {
+        vector<shared_ptr<GroupElement>> scapiU(n), scapiV(n);
+        vector<biginteger> scapiScalars(n);
+        vector<NativeECPoint> nativeU, nativeV;
+        vector<BigNumPtr> nativeScalars;
+        vector<const EC_POINT *> uPoints(n), vPoints(n);
+        vector<const BIGNUM *> scalars(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            scapiU[i] = dlog->createRandomElement();
+            scapiV[i] = dlog->createRandomElement();
+            scapiScalars[i] = getRandomInRange(0, scapiElGamal.getQMinusOne(), random.get());
+            nativeU.push_back(nativeGroup->newPoint());
+            nativeV.push_back(nativeGroup->newPoint());
+            nativeGroup->setAffine(nativeU[i], ((ECElement *)scapiU[i].get())->getX(), ((ECElement *)scapiU[i].get())->getY(), false);
+            nativeGroup->setAffine(nativeV[i], ((ECElement *)scapiV[i].get())->getX(), ((ECElement *)scapiV[i].get())->getY(), false);
+            nativeScalars.push_back(nativeGroup->toScalar(scapiScalars[i]));
+            uPoints[i] = nativeU[i].get();
+            vPoints[i] = nativeV[i].get();
+            scalars[i] = nativeScalars[i].get();
+        }
+
+        NativeECPoint wnafU = nativeGroup->newPoint(), wnafV = nativeGroup->newPoint();
+        NativeECPoint pippengerU = nativeGroup->newPoint(), pippengerV = nativeGroup->newPoint();
+        unsigned int windowSize = NativeECGroup::pippengerWindowSize(n);
+        size_t multiRepetitions = std::max(size_t(1), repetitions * 20 / n);
+
+        auto scapiTime = measure([&]()
+                                 { for (size_t r = 0; r < multiRepetitions; r++) {
+                                       dlog->simultaneousMultipleExponentiations(scapiU, scapiScalars);
+                                       dlog->simultaneousMultipleExponentiations(scapiV, scapiScalars); } });
+        auto wnafTime = measure([&]()
+                                { for (size_t r = 0; r < multiRepetitions; r++) {
+                                      nativeGroup->multiMul(wnafU, uPoints, scalars);
+                                      nativeGroup->multiMul(wnafV, vPoints, scalars); } });
+        auto pippengerTime = measure([&]()
+                                     { for (size_t r = 0; r < multiRepetitions; r++)
+                                           nativeGroup->pippengerPair(pippengerU, pippengerV, uPoints, vPoints, scalars, windowSize); });
+        allPassed &= check(nativeGroup->equals(wnafU, pippengerU) && nativeGroup->equals(wnafV, pippengerV), "Pippenger n=" + to_string(n));
+        cout << n << "," << windowSize << "," << scapiTime / multiRepetitions << "," << wnafTime / multiRepetitions << "," << pippengerTime / multiRepetitions << endl;
+    }
+    cout << "Pippenger threshold of " << curveName << ": " << nativeGroup->getPippengerThreshold() << endl;
+
+    // Indexed randomized equality of many bins with short items: per-bin wNAF vs. window tables built once per index vector
+    size_t numberOfBins = repetitions * 10;
+    vector<vector<biginteger>> bins(numberOfBins, vector<biginteger>(vectorSize));
+    for (auto &bin : bins)
+    {
+        for (auto &item : bin)
+        {
+            item = getRandomInRange(0, biginteger(UINT32_MAX), random.get());
+        }
+    }
+    auto nativeMinusItem = nativeElGamal.encrypt(make_shared<BigIntegerPlainText>(biginteger(-bins[0][1])));
+    auto nativeZero = nativeElGamal.encrypt(make_shared<BigIntegerPlainText>(zero));
+    cout << "window,bins,wNAF[µs],tables[µs],tables+offline recoding[µs]" << endl;
+    for (unsigned int windowSize : {2u, 4u, 6u})
+    {
+        NativeIndexTables tables;
+        vector<NativeRecodedScalars> recodedBins(numberOfBins);
+        for (size_t b = 0; b < numberOfBins; b++)
+        {
+            nativeElGamal.recodePlaintexts(recodedBins[b], bins[b], 32, windowSize);
+        }
+        auto wnafTime = measure([&]()
+                                { for (auto &bin : bins) nativeElGamal.indexedRandomizedEquality(nativeIndexPtr, bin, nativeMinusItem.get(), nativeZero.get()); });
+        auto tablesTime = measure([&]()
+                                  { nativeElGamal.buildIndexTables(tables, nativeIndexPtr, 32, windowSize);
+                                    for (auto &bin : bins) nativeElGamal.tabledIndexedRandomizedEquality(tables, bin, nativeMinusItem.get(), nativeZero.get()); });
+        auto recodedTime = measure([&]()
+                                   { nativeElGamal.buildIndexTables(tables, nativeIndexPtr, 32, windowSize);
+                                     for (auto &recoded : recodedBins) nativeElGamal.tabledIndexedRandomizedEquality(tables, recoded, nativeMinusItem.get(), nativeZero.get()); });
+        allPassed &= check(nativeElGamal.decryptsToZero(nativeElGamal.tabledIndexedRandomizedEquality(tables, recodedBins[0], nativeMinusItem.get(), nativeZero.get()).get()) &&
+                               !nativeElGamal.decryptsToZero(nativeElGamal.tabledIndexedRandomizedEquality(tables, bins[1], nativeMinusItem.get(), nativeZero.get()).get()),
+                           "index tables w=" + to_string(windowSize));
+        cout << windowSize << "," << numberOfBins << "," << wnafTime << "," << tablesTime << "," << recodedTime << endl;
+    }
+
+    // ristretto255 (native only, native keys), client and server side exchange key and ciphertexts over the wire format
+    AddHomElGamalEnc ristrettoClient;
+    ristrettoClient.enableNativeBackend(RISTRETTO255_CURVE_NAME);
+    ristrettoClient.generateNativeKey();
+    AddHomElGamalEnc ristrettoServer;
+    ristrettoServer.enableNativeBackend(RISTRETTO255_CURVE_NAME);
+    ristrettoServer.setNativePublicKey(ristrettoClient.getEncodedNativePublicKey());
+    auto ristrettoGroup = ristrettoClient.getNativeGroup();
+
+    // Test vectors of RFC 9496: generator, 2 * generator and encodings that have to be rejected
+    NativeECPoint twoG = ristrettoGroup->newPoint();
+    ristrettoGroup->dbl(twoG, ristrettoGroup->getGenerator());
+    allPassed &= check(ristrettoGroup->encode(ristrettoGroup->getGenerator()) == "e2f2ae0a6abc4e71a884a961c500515f58e30b6aa582dd8db6a65945e08d2d76" &&
+                           ristrettoGroup->encode(twoG) == "6a493210f7499cd17fecb510ae0cea23a110e8d5b901f8acadd3095c73a3b919",
+                       "ristretto255 encoding");
+    bool rejected = true;
+    for (const string &invalid : vector<string>{string(64, 'f'), "01" + string(62, '0'), "26948d35ca62e643e26a83177332e6b6afeb9d08e4268b650f1f5bbd8d81d371"})
+    {
+        try
+        {
+            NativeECPoint point = ristrettoGroup->newPoint();
+            ristrettoGroup->decode(point, invalid, true);
+            rejected = false;
+        }
+        catch (const invalid_argument &)
+        {
+        }
+    }
+    allPassed &= check(rejected, "ristretto255 rejects invalid encodings");
+
+    auto ristrettoFive = ristrettoClient.encrypt(make_shared<BigIntegerPlainText>(five));
+    auto ristrettoMinusFive = ristrettoClient.encrypt(make_shared<BigIntegerPlainText>(minusFive));
+    auto receivedFive = ristrettoServer.reconstructCiphertext(ristrettoFive->generateSendableData()->toString());
+    auto serverResult = ristrettoServer.randomizedEquality(receivedFive.get(), minusFive, nullptr);
+    ristrettoServer.normalize(serverResult.get());
+    auto receivedResult = ristrettoClient.reconstructCiphertext(serverResult->generateSendableData()->toString(), false);
+    allPassed &= check(ristrettoClient.decryptsToZero(receivedResult.get()) &&
+                           !ristrettoClient.decryptsToZero(ristrettoServer.randomizedEquality(receivedFive.get(), five, nullptr).get()),
+                       "ristretto255 wire format");
+    allPassed &= check(ristrettoClient.decryptsToZero(ristrettoClient.add(ristrettoFive.get(), ristrettoMinusFive.get()).get()) &&
+                           ristrettoServer.checkMembershipBatch({receivedFive.get()}),
+                       "ristretto255 add");
+
+    // Same operations as above, native curveName vs. ristretto255
+    cout << "Operation," << curveName << "[µs],ristretto255[µs]" << endl;
+    auto compare = [&](const string &name, const std::function<void(AddHomElGamalEnc &, AsymmetricCiphertext *)> &op)
+    {
+        auto curveTime = measure([&]()
+                                 { for (size_t r = 0; r < repetitions; r++) op(nativeElGamal, nativeFive.get()); });
+        auto ristrettoTime = measure([&]()
+                                     { for (size_t r = 0; r < repetitions; r++) op(ristrettoServer, receivedFive.get()); });
+        cout << name << "," << curveTime << "," << ristrettoTime << endl;
+    };
+    compare("encrypt", [&](AddHomElGamalEnc &enc, AsymmetricCiphertext *)
+            { enc.encrypt(make_shared<BigIntegerPlainText>(five)); });
+    compare("multByConst", [&](AddHomElGamalEnc &enc, AsymmetricCiphertext *cipher)
+            { enc.multByConst(cipher, exponents[0]); });
+    compare("randomizedEquality", [&](AddHomElGamalEnc &enc, AsymmetricCiphertext *cipher)
+            { enc.randomizedEquality(cipher, five, nullptr); });
+    compare("encode", [&](AddHomElGamalEnc &enc, AsymmetricCiphertext *cipher)
+            { cipher->generateSendableData()->toString(); });
+    compare("reconstruct", [&](AddHomElGamalEnc &enc, AsymmetricCiphertext *cipher)
+            { enc.reconstructCiphertext(cipher->generateSendableData()->toString()); });
+    cout << "ciphertext bytes," << nativeFive->generateSendableData()->toString().size() << "," << receivedFive->generateSendableData()->toString().size() << endl;
+
+    return checksResult(allPassed);
+}
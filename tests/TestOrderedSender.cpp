@@ -0,0 +1,80 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "src/Common/OrderedSender.hpp"
+#include "src/Common/WorkStealingPool.hpp"
+#include "tests/TestChecks.hpp"
+
+using namespace std;
+
+/**
+ * @brief Completes jobs out of order on a WorkStealingPool, as the servers do with their PIEs, and checks that they are sent
+ *        exactly once and in job order, that a failed send is rethrown and that an unfinished sender can be destroyed.
+ */
+int main(int argc, char *argv[])
+{
+    bool allPassed = true;
+    const size_t numberOfJobs = 500;
+    for (size_t numberOfWorkers : {1, 4})
+    {
+        WorkStealingPool pool(numberOfWorkers);
+        vector<size_t> sent; // only used by the sender thread until finish
+        {
+            OrderedSender sender(numberOfJobs, [&sent](size_t job)
+                                 { sent.push_back(job); });
+            OrderedSender *senderPointer = &sender;
+            // Later jobs are cheaper, i.e., they tend to complete first
+            for (size_t job = 0; job < numberOfJobs; job++)
+            {
+                pool.submit([senderPointer, job](size_t)
+                            {
+                                volatile double busy = 0;
+                                for (size_t k = 0; k < (numberOfJobs - job) * 1000; k++)
+                                {
+                                    busy += k;
+                                }
+                                senderPointer->complete(job); });
+            }
+            pool.wait();
+            sender.finish();
+        }
+        bool inOrder = sent.size() == numberOfJobs;
+        for (size_t i = 0; inOrder && i < numberOfJobs; i++)
+        {
+            inOrder = sent[i] == i;
+        }
+        allPassed &= check(inOrder, to_string(numberOfWorkers) + " workers, job order");
+    }
+
+    bool rethrown = false;
+    {
+        OrderedSender sender(2, [](size_t job)
+                             {
+                                 if (job == 1)
+                                 {
+                                     throw runtime_error("failing send");
+                                 } });
+        sender.complete(1);
+        sender.complete(0);
+        try
+        {
+            sender.finish();
+        }
+        catch (runtime_error &)
+        {
+            rethrown = true;
+        }
+    }
+    allPassed &= check(rethrown, "failing send");
+
+    {
+        OrderedSender sender(3, [](size_t) {});
+        sender.complete(0);
+        sender.complete(2);
+        // Job 1 never completes, the destructor must not block
+    }
+    allPassed &= check(true, "unfinished sender");
+
+    return checksResult(allPassed);
+}
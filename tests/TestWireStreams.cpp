@@ -0,0 +1,75 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "src/Common/WireStreams.hpp"
+#include "tests/TestChecks.hpp"
+
+using namespace std;
+
+/**
+ * @brief Writes a mix of single characters, small and large blocks and formatted values, as a serializer would.
+ */
+template <typename Stream>
+void writeMix(Stream &stream)
+{
+    for (int i = 0; i < 1000; i++)
+    {
+        uint64_t value = 0x0102030405060708ULL * i;
+        stream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        stream.put(char(i));
+        stream << i << ' ';
+    }
+    string large(100000, 'x');
+    large[5] = '\0';
+    stream.write(large.data(), large.size());
+}
+
+/**
+ * @brief Writes the same mix into StringOutStreams with different initial sizes and an ostringstream, and reads it back
+ *        from the received bytes with a FrameInStream.
+ */
+int main(int argc, char *argv[])
+{
+    bool allPassed = true;
+
+    ostringstream reference;
+    writeMix(reference);
+    for (size_t initialSize : {0, 1, 4096, 1 << 20})
+    {
+        StringOutStream stream(initialSize);
+        writeMix(stream);
+        size_t written = stream.size();
+        string taken = stream.take();
+        allPassed &= check(taken == reference.str() && written == taken.size(),
+                           "output with initial size " + to_string(initialSize));
+        // A taken stream starts over
+        stream << "again";
+        allPassed &= check(stream.take() == "again" && stream.good(), "output after take, initial size " + to_string(initialSize));
+    }
+
+    string expected = reference.str();
+    vector<unsigned char> frame(expected.begin(), expected.end());
+    FrameInStream in(frame);
+    bool sameValues = true;
+    for (int i = 0; i < 1000; i++)
+    {
+        uint64_t value;
+        in.read(reinterpret_cast<char *>(&value), sizeof(value));
+        char c = in.get();
+        int number;
+        in >> number;
+        in.get();
+        sameValues &= value == 0x0102030405060708ULL * i && c == char(i) && number == i;
+    }
+    string large(100000, ' ');
+    in.read(&large[0], large.size());
+    allPassed &= check(sameValues && in.good() && large[5] == '\0' && large[6] == 'x', "input reads the frame in place");
+    allPassed &= check(in.peek() == char_traits<char>::eof() && in.eof(), "input ends with the frame");
+
+    in.clear();
+    in.seekg(8);
+    allPassed &= check(in.get() == char(0) && in.tellg() == 9, "input seeks");
+
+    return checksResult(allPassed);
+}
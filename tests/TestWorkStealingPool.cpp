@@ -0,0 +1,133 @@
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <vector>
+#include <stdexcept>
+#include "src/Common/WorkStealingPool.hpp"
+#include "tests/TestChecks.hpp"
+
+using namespace std;
+
+/**
+ * @brief Runs uneven tasks, all queued at a single worker, on pools of several sizes and checks that every task runs exactly once
+ *        and that the pool survives several rounds and a failing task, as the servers reuse it across all phases.
+ */
+int main(int argc, char *argv[])
+{
+    bool allPassed = true;
+    const size_t numberOfTasks = 1000;
+    for (size_t numberOfWorkers : {1, 3, 7})
+    {
+        WorkStealingPool pool(numberOfWorkers);
+        for (int round = 0; round < 3; round++)
+        {
+            vector<atomic<int>> runs(numberOfTasks);
+            vector<atomic<int>> tasksPerWorker(numberOfWorkers);
+            for (size_t i = 0; i < numberOfTasks; i++)
+            {
+                runs[i] = 0;
+            }
+            for (size_t i = 0; i < numberOfTasks; i++)
+            {
+                pool.submit(0, [&runs, &tasksPerWorker, i](size_t worker)
+                            {
+                                volatile double busy = 0;
+                                for (size_t k = 0; k < (i % 10) * 10000; k++)
+                                {
+                                    busy += k;
+                                }
+                                runs[i]++;
+                                tasksPerWorker[worker]++; });
+            }
+            pool.wait();
+
+            bool allOnce = true;
+            for (auto &count : runs)
+            {
+                allOnce &= count == 1;
+            }
+            int total = 0;
+            for (auto &count : tasksPerWorker)
+            {
+                total += count;
+            }
+            allPassed &= check(allOnce && total == int(numberOfTasks),
+                               to_string(numberOfWorkers) + " workers, round " + to_string(round));
+        }
+
+        pool.submit([](size_t)
+                    { throw invalid_argument("failing task"); });
+        bool rethrown = false;
+        try
+        {
+            pool.wait();
+        }
+        catch (invalid_argument &)
+        {
+            rethrown = true;
+        }
+        atomic<int> afterError(0);
+        pool.submit([&afterError](size_t)
+                    { afterError++; });
+        pool.wait();
+        allPassed &= check(rethrown && afterError == 1, to_string(numberOfWorkers) + " workers, failing task");
+
+        // Tasks split with parallelFor (as the PIEs are), a worker never runs two bodies at once
+        const size_t numberOfSplitTasks = 20, indicesPerTask = 200;
+        vector<atomic<int>> indexRuns(numberOfSplitTasks * indicesPerTask);
+        vector<atomic<int>> busyWorkers(numberOfWorkers);
+        atomic<bool> overlapping(false), wrongWorker(false);
+        for (auto &count : indexRuns)
+        {
+            count = 0;
+        }
+        for (auto &busy : busyWorkers)
+        {
+            busy = 0;
+        }
+        for (size_t t = 0; t < numberOfSplitTasks; t++)
+        {
+            pool.submit([&, t](size_t)
+                        { pool.parallelFor(indicesPerTask, numberOfWorkers, [&, t](size_t index, size_t worker)
+                                           {
+                                               wrongWorker = wrongWorker || worker != pool.currentWorker();
+                                               overlapping = overlapping || busyWorkers[worker]++ != 0;
+                                               volatile double spin = 0;
+                                               for (size_t k = 0; k < (index % 7) * 2000; k++)
+                                               {
+                                                   spin += k;
+                                               }
+                                               busyWorkers[worker]--;
+                                               indexRuns[t * indicesPerTask + index]++; }); });
+        }
+        pool.wait();
+        bool allIndicesOnce = true;
+        for (auto &count : indexRuns)
+        {
+            allIndicesOnce &= count == 1;
+        }
+        allPassed &= check(allIndicesOnce && !overlapping && !wrongWorker, to_string(numberOfWorkers) + " workers, parallelFor in tasks");
+
+        atomic<int> outsideRuns(0);
+        bool forRethrown = false;
+        try
+        {
+            pool.parallelFor(100, numberOfWorkers, [&outsideRuns](size_t index, size_t)
+                             {
+                                 outsideRuns++;
+                                 if (index == 42)
+                                 {
+                                     throw invalid_argument("failing index");
+                                 } });
+        }
+        catch (invalid_argument &)
+        {
+            forRethrown = true;
+        }
+        pool.wait();
+        allPassed &= check(forRethrown && outsideRuns == 100 && pool.currentWorker() == pool.size(),
+                           to_string(numberOfWorkers) + " workers, parallelFor from outside");
+    }
+
+    return checksResult(allPassed);
+}